@@ -456,6 +456,21 @@ DEFINES += SPL_MERGED_LIBRARY_SINGLE_FILE
 # should we attempt to precompile the Qt moc_*.cpp files for speed?
 DEFINES += SPL_PRECOMPILE_QT_MOC_FILES
 
+# build without the Qt GUI, for batch runs on machines with no display:
+#   qmake "CONFIG+=headless"
+# The program then runs a batch job when it is given command-line options
+# (see src/batch.h) and plays the game in the plain console otherwise.
+# life.cpp supplies the real main function in this build (QT_NEEDS_QMAIN
+# stops the library from defining its own).
+headless {
+    QT -= gui widgets multimedia network
+    DEFINES += SPL_HEADLESS_MODE
+    DEFINES += QT_NEEDS_QMAIN
+    DEFINES -= SPL_CONSOLE_ECHO
+    DEFINES -= SPL_CONSOLE_EXIT_ON_CLOSE
+    DEFINES -= SPL_PRECOMPILE_QT_MOC_FILES
+}
+
 # build-specific options (debug vs release)
 
 # make 'debug' target (default) use no optimization, generate debugger symbols,
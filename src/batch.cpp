@@ -0,0 +1,463 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the batch runner.
+ * See batch.h for the documentation of the command-line options.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "batch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "boardfile.h"
+#include "cellboard.h"
+#include "error.h"
+#include "frameexport.h"
+#include "hashlife.h"
+#include "lifeengine.h"
+#include "lifekernel.h"
+#include "strlib.h"
+#include "telemetry.h"
+
+using namespace std;
+
+/*
+ * The settings of one batch run.
+ */
+struct BatchOptions {
+    string input;
+    string output;
+    string engine;
+    long long generations;
+    int threads;
+    int kernel;     // a KernelKind, or -1 for the default
+    string frames;  // the prefix of the frame files, or "" for none
+    long long frameEvery;
+    int frameScale;
+    FrameFormat frameFormat;
+    string telemetry;   // the telemetry log file, or "" for none
+    TelemetryFormat telemetryFormat;
+    string tileStats;   // the tile statistics file, or "" for none
+    long long hashLifeMemory;   // HashLife's memory limit in bytes, or -1 for the default
+};
+
+/*
+ * The tile scheduler's statistics summed over a run.
+ */
+struct TileTotals {
+    long long records;  // generations recorded
+    long long processed;
+    long long skipped;
+    long long tasks;
+    long long steals;
+    double idleMs;
+    double elapsedMs;
+};
+
+// the largest number of pixels a cell can be in a frame
+static const int MAX_FRAME_SCALE = 64;
+
+static int usage(const string& program, const string& problem) {
+    cerr << program << ": " << problem << endl;
+    cerr << "usage: " << program << " --input FILE [--generations N]"
+         << " [--engine tiles|bands|hashlife] [--threads N]"
+         << " [--kernel swar|sse2|avx2] [--output FILE]"
+         << " [--frames PREFIX [--frame-every N] [--frame-scale N] [--frame-format png|ppm]]"
+         << " [--telemetry FILE [--telemetry-format csv|binary]] [--tile-stats FILE]"
+         << " [--hashlife-memory BYTES]" << endl;
+    return 2;
+}
+
+/*
+ * Reads a whole non-negative number, returning false if text is not one.
+ */
+static bool parseCount(const string& text, long long& value) {
+    if (text.empty() || text.length() > 18) {
+        return false;
+    }
+    value = 0;
+    for (char ch : text) {
+        if (ch < '0' || ch > '9') {
+            return false;
+        }
+        value = value * 10 + (ch - '0');
+    }
+    return true;
+}
+
+/*
+ * Fills in options from the command line, returning an error message or
+ * the empty string if the options are valid.
+ */
+static string parseOptions(int argc, char** argv, BatchOptions& options) {
+    options.generations = 100;
+    options.engine = "tiles";
+    options.threads = 0;
+    options.kernel = -1;
+    options.frameEvery = 1;
+    options.frameScale = 1;
+    options.frameFormat = FRAME_PNG;
+    options.telemetryFormat = TELEMETRY_CSV;
+    options.hashLifeMemory = -1;
+    for (int i = 1; i < argc; i++) {
+        // an option's value is the next argument, or follows an = in it
+        string name = argv[i];
+        string value;
+        size_t equals = name.find('=');
+        if (equals != string::npos) {
+            value = name.substr(equals + 1);
+            name = name.substr(0, equals);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            return "missing value for " + name;
+        }
+        long long count = 0;
+        if (name == "--input") {
+            options.input = value;
+        } else if (name == "--output") {
+            options.output = value;
+        } else if (name == "--generations") {
+            if (!parseCount(value, count)) {
+                return "--generations must be a whole number, not " + value;
+            }
+            options.generations = count;
+        } else if (name == "--engine") {
+            if (value != "tiles" && value != "bands" && value != "hashlife") {
+                return "unknown engine " + value;
+            }
+            options.engine = value;
+        } else if (name == "--threads") {
+            if (!parseCount(value, count) || count > 1024) {
+                return "--threads must be a number from 0 to 1024, not " + value;
+            }
+            options.threads = (int) count;
+        } else if (name == "--kernel") {
+            for (int kind = KERNEL_SWAR; kind <= KERNEL_AVX2; kind++) {
+                if (kernelName((KernelKind) kind) == value) {
+                    options.kernel = kind;
+                }
+            }
+            if (options.kernel < 0) {
+                return "unknown kernel " + value;
+            }
+            if (!isKernelSupported((KernelKind) options.kernel)) {
+                return "this CPU does not support the " + value + " kernel";
+            }
+        } else if (name == "--frames") {
+            options.frames = value;
+        } else if (name == "--frame-every") {
+            if (!parseCount(value, count) || count == 0) {
+                return "--frame-every must be a positive whole number, not " + value;
+            }
+            options.frameEvery = count;
+        } else if (name == "--frame-scale") {
+            if (!parseCount(value, count) || count == 0 || count > MAX_FRAME_SCALE) {
+                return "--frame-scale must be a number from 1 to " + integerToString(MAX_FRAME_SCALE)
+                        + ", not " + value;
+            }
+            options.frameScale = (int) count;
+        } else if (name == "--frame-format") {
+            if (value != "png" && value != "ppm") {
+                return "unknown frame format " + value;
+            }
+            options.frameFormat = value == "png" ? FRAME_PNG : FRAME_PPM;
+        } else if (name == "--telemetry") {
+            options.telemetry = value;
+        } else if (name == "--telemetry-format") {
+            if (value != "csv" && value != "binary") {
+                return "unknown telemetry format " + value;
+            }
+            options.telemetryFormat = value == "csv" ? TELEMETRY_CSV : TELEMETRY_BINARY;
+        } else if (name == "--tile-stats") {
+            options.tileStats = value;
+        } else if (name == "--hashlife-memory") {
+            if (!parseCount(value, count)) {
+                return "--hashlife-memory must be a whole number of bytes, not " + value;
+            }
+            options.hashLifeMemory = count;
+        } else {
+            return "unknown option " + name;
+        }
+    }
+    if (options.input.empty()) {
+        return "no --input file given";
+    }
+    if (!options.telemetry.empty() && options.engine == "hashlife") {
+        return "--telemetry needs the tiles or bands engine";
+    }
+    if (!options.tileStats.empty() && options.engine != "tiles") {
+        return "--tile-stats needs the tiles engine";
+    }
+    if (options.hashLifeMemory >= 0 && options.engine != "hashlife") {
+        return "--hashlife-memory needs the hashlife engine";
+    }
+    return "";
+}
+
+/*
+ * Returns true if filename names a Macrocell file.
+ */
+static bool isMacrocellName(const string& filename) {
+    return endsWith(toLowerCase(filename), MACROCELL_EXTENSION);
+}
+
+/*
+ * Appends the tile scheduler's statistics of one generation to a
+ * --tile-stats file as a CSV line, and adds them to total.
+ */
+static void recordTileStats(ostream& out, long long generation, const TileStats& stats,
+                            TileTotals& total) {
+    out << generation << ',' << stats.tiles << ',' << stats.processed << ','
+        << stats.skipped << ',' << stats.tasks << ',' << stats.steals << ','
+        << stats.threads << ',' << stats.idleMs << ',' << stats.elapsedMs << '\n';
+    total.records++;
+    total.processed += stats.processed;
+    total.skipped += stats.skipped;
+    total.tasks += stats.tasks;
+    total.steals += stats.steals;
+    total.idleMs += stats.idleMs;
+    total.elapsedMs += stats.elapsedMs;
+}
+
+/*
+ * Escapes a string for a JSON string literal.
+ */
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            quoted += '\\';
+            quoted += ch;
+        } else if ((unsigned char) ch < 0x20) {
+            quoted += ' ';
+        } else {
+            quoted += ch;
+        }
+    }
+    return quoted + "\"";
+}
+
+int runBatch(int argc, char** argv) {
+    string program = argc > 0 ? argv[0] : "life";
+    BatchOptions options;
+    string problem = parseOptions(argc, argv, options);
+    if (!problem.empty()) {
+        return usage(program, problem);
+    }
+
+    if (options.kernel >= 0) {
+        setKernel((KernelKind) options.kernel);
+    }
+    // the threads load a text board as well as advancing it
+    LifeEngine::setThreadCount(options.threads);
+    LifeEngine::setSchedule(options.engine == "bands" ? SCHEDULE_BANDS : SCHEDULE_TILES);
+
+    // a Macrocell file run with HashLife goes straight into its quadtree,
+    // which is advanced node by node, so the board is never held cell by
+    // cell unless frames or a cell-by-cell output ask for it
+    bool treeOnly = options.engine == "hashlife" && isMacrocellName(options.input);
+    CellBoard board;
+    HashLife hashLife;
+    if (options.hashLifeMemory >= 0) {
+        hashLife.setMemoryLimit((size_t) options.hashLifeMemory);
+    }
+    uint64_t startGeneration = 0;
+    try {
+        if (treeOnly) {
+            ifstream input(options.input.c_str(), ios::binary);
+            if (!input) {
+                error("cannot read " + options.input);
+            }
+            startGeneration = hashLife.readMacrocell(input);
+        } else {
+            readBoardFile(options.input, board, startGeneration);
+        }
+    } catch (const ErrorException& ex) {
+        cerr << program << ": " << ex.getMessage() << endl;
+        return 1;
+    }
+
+    // the generations are run with nothing else in the timed loop but
+    // copying out the boards of the frames, which are written on another
+    // thread; HashLife jumps from one frame to the next
+    unique_ptr<FrameExporter> exporter;
+    if (!options.frames.empty()) {
+        exporter.reset(new FrameExporter(options.frames, options.frameFormat,
+                                         options.frameScale, options.frameEvery));
+    }
+    long long generations = 0;
+    long long stableAt = -1;
+    double ms = 0;
+    unique_ptr<TelemetryLog> telemetry;
+    try {
+        if (!options.telemetry.empty()) {
+            telemetry.reset(new TelemetryLog(options.telemetry, options.telemetryFormat));
+            telemetry->start(board, (long long) startGeneration);
+        }
+    } catch (const ErrorException& ex) {
+        cerr << program << ": " << ex.getMessage() << endl;
+        return 1;
+    }
+    // the tile statistics are reset every generation, so they are written
+    // out a line per generation as the run goes, and summed for the summary
+    ofstream tileStats;
+    TileTotals tileTotal = TileTotals();
+    if (!options.tileStats.empty()) {
+        tileStats.open(options.tileStats.c_str(), ios::trunc);
+        if (!tileStats) {
+            cerr << program << ": cannot write " << options.tileStats << endl;
+            return 1;
+        }
+        tileStats << "generation,tiles,processed,skipped,tasks,steals,threads,idle_ms,elapsed_ms\n";
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    try {
+        if (options.engine == "hashlife") {
+            if (!treeOnly) {
+                hashLife.load(board);
+            }
+            if (!exporter) {
+                hashLife.advance((uint64_t) options.generations);
+                generations = options.generations;
+            } else {
+                hashLife.toBoard(board);
+                exporter->submit(board, 0);
+                while (generations < options.generations) {
+                    long long step = min(options.frameEvery, options.generations - generations);
+                    hashLife.advance((uint64_t) step);
+                    generations += step;
+                    if (exporter->isDue(generations)) {
+                        hashLife.toBoard(board);
+                        exporter->submit(board, generations);
+                    }
+                }
+            }
+        } else {
+            CellBoard next(board.numRows(), board.numCols());
+            if (exporter) {
+                exporter->submit(board, 0);
+            }
+            RegionCounts counts;
+            while (generations < options.generations) {
+                if (!LifeEngine::advance(board, next, telemetry ? &counts : nullptr)) {
+                    stableAt = generations;
+                    break;
+                }
+                board.swap(next);
+                generations++;
+                if (exporter) {
+                    exporter->submit(board, generations);
+                }
+                if (telemetry) {
+                    telemetry->record(counts);
+                }
+                if (tileStats.is_open()) {
+                    recordTileStats(tileStats, (long long) startGeneration + generations,
+                                    LifeEngine::getTileStats(), tileTotal);
+                }
+            }
+        }
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (exporter) {
+            exporter->finish();
+        }
+        if (telemetry) {
+            telemetry->finish();
+        }
+        if (tileStats.is_open()) {
+            tileStats.close();
+            if (!tileStats) {
+                error("cannot write " + options.tileStats);
+            }
+        }
+    } catch (const ErrorException& ex) {
+        cerr << program << ": " << ex.getMessage() << endl;
+        return 1;
+    }
+
+    // a board that stopped changing is the same at every later generation
+    uint64_t endGeneration = startGeneration + options.generations;
+    bool treeOutput = options.engine == "hashlife"
+            && (options.output.empty() || isMacrocellName(options.output));
+    if (options.engine == "hashlife" && !treeOutput) {
+        hashLife.toBoard(board);
+    }
+    if (!options.output.empty()) {
+        try {
+            if (treeOutput) {
+                ofstream output(options.output.c_str(), ios::binary);
+                hashLife.writeMacrocell(output, endGeneration);
+                output.close();
+                if (!output) {
+                    error("cannot write " + options.output);
+                }
+            } else {
+                writeBoardFile(options.output, board, endGeneration);
+            }
+        } catch (const ErrorException& ex) {
+            cerr << program << ": " << ex.getMessage() << endl;
+            return 1;
+        }
+    }
+
+    int rows = treeOutput ? hashLife.numRows() : board.numRows();
+    int cols = treeOutput ? hashLife.numCols() : board.numCols();
+    uint64_t counts[4] = {0, 0, 0, 0};
+    for (int state = DECAYING; state <= ALIVE; state++) {
+        counts[state] = treeOutput ? hashLife.population((CellState) state)
+                                   : board.count((CellState) state);
+    }
+    double cellGenerations = (double) rows * cols * generations;
+    cout << "{\"input\":" << jsonString(options.input)
+         << ",\"rows\":" << rows
+         << ",\"cols\":" << cols
+         << ",\"engine\":" << jsonString(options.engine)
+         << ",\"threads\":" << (options.engine == "hashlife" ? 1 : LifeEngine::getThreadCount())
+         << ",\"kernel\":" << jsonString(kernelName(getKernel()))
+         << ",\"generations\":" << options.generations
+         << ",\"computed\":" << generations
+         << ",\"generation\":" << endGeneration
+         << ",\"stable_at\":" << stableAt
+         << ",\"elapsed_ms\":" << ms
+         << ",\"cells_per_second\":" << fixed << setprecision(0)
+         << (ms > 0 ? floor(cellGenerations * 1000.0 / ms) : 0.0)
+         << ",\"alive\":" << counts[ALIVE]
+         << ",\"dying\":" << counts[DYING]
+         << ",\"decaying\":" << counts[DECAYING];
+    if (exporter) {
+        cout << ",\"frames\":" << exporter->getFramesWritten();
+    }
+    if (telemetry) {
+        cout << ",\"telemetry_records\":" << telemetry->getRecordsWritten();
+    }
+    if (!options.tileStats.empty()) {
+        cout << ",\"tile_stats\":{\"records\":" << tileTotal.records
+             << ",\"processed\":" << tileTotal.processed
+             << ",\"skipped\":" << tileTotal.skipped
+             << ",\"tasks\":" << tileTotal.tasks
+             << ",\"steals\":" << tileTotal.steals
+             << setprecision(3) << ",\"idle_ms\":" << tileTotal.idleMs
+             << ",\"elapsed_ms\":" << tileTotal.elapsedMs << "}";
+    }
+    if (options.engine == "hashlife") {
+        HashLifeStats stats = hashLife.getStats();
+        cout << ",\"hashlife\":{\"memory_limit\":" << hashLife.getMemoryLimit()
+             << ",\"hits\":" << stats.hits
+             << ",\"misses\":" << stats.misses
+             << ",\"evictions\":" << stats.evictions
+             << ",\"freed_nodes\":" << stats.freedNodes
+             << ",\"collections\":" << stats.collections
+             << ",\"nodes\":" << stats.nodes
+             << ",\"bytes\":" << stats.bytes << "}";
+    }
+    cout << "}" << endl;
+    return 0;
+}
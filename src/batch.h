@@ -0,0 +1,68 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the batch runner, which runs a simulation from the
+ * command line with no prompts, console window, or GUI.
+ * See batch.cpp for the implementation.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _batch_h
+#define _batch_h
+
+/**
+ * Runs one simulation described by command-line options and prints a
+ * one-line JSON summary of it to standard output:
+ *
+ *   --input FILE        the board to start from (required), in any format
+ *                       readBoardFile reads: text, RLE, Macrocell, or snapshot
+ *   --generations N     how many generations to run (default 100)
+ *   --engine NAME       tiles, bands, or hashlife (default tiles)
+ *   --threads N         threads for tiles/bands; 0 is one per core (default 0)
+ *   --kernel NAME       swar, sse2, or avx2 (default: the fastest supported)
+ *   --output FILE       write the final board here, in the format given by
+ *                       its extension as for writeBoardFile
+ *   --frames PREFIX     write generation 0 and every Nth generation after
+ *                       it as numbered images PREFIX000000.png, ...
+ *   --frame-every N     the N for --frames (default 1)
+ *   --frame-scale N     pixels on a side of a cell in the images (default 1)
+ *   --frame-format FMT  png or ppm (default png)
+ *   --telemetry FILE    log the census of every generation (populations,
+ *                       births, deaths, changes, bounding box) to FILE as
+ *                       a TelemetryLog; tiles and bands only
+ *   --telemetry-format FMT  csv or binary (default csv)
+ *   --tile-stats FILE   write the tile scheduler's statistics of every
+ *                       generation (tiles active and skipped, tasks,
+ *                       steals, threads, idle and elapsed ms) to FILE as
+ *                       CSV, a line per generation; tiles only
+ *   --hashlife-memory BYTES the memory limit of HashLife's nodes and cached
+ *                       results; 0 is no limit (default 1 GB)
+ *
+ * An option's value can also be given after an =, as in --generations=500.
+ * With hashlife, the summary ends with HashLife's cache counters: results
+ * found and computed, results evicted, nodes freed, garbage collections,
+ * and the nodes and bytes in use at the end.  With --tile-stats, it ends
+ * with the number of lines written and the sum of each statistic over the
+ * run.
+ *
+ * Nothing is printed between generations, so the time measured is the
+ * time spent computing them, copying out the boards of any frames, and
+ * logging any telemetry; the frames are written by a FrameExporter on a
+ * background thread, and the run waits for the last of them after the
+ * time is taken.  With tiles or bands the run stops early once the board
+ * stops changing, since every later generation is the same (so no frames
+ * or telemetry are written after that).  With hashlife and frames, the
+ * run jumps from one frame's generation to the next.
+ * With hashlife, a Macrocell input is loaded straight into the quadtree,
+ * which every step works on as well, and with a Macrocell output or none,
+ * the board is never expanded into cells, so a sparse pattern on a board
+ * far bigger than memory can be run from file to file; a run costs about
+ * what the pattern's own nodes do, however large the board.
+ *
+ * Returns the exit status for the program: 0 on success, 1 if a file could
+ * not be read or written, and 2 if the options are not valid, in which
+ * case a usage message is printed to standard error.
+ */
+int runBatch(int argc, char** argv);
+
+#endif // _batch_h
@@ -0,0 +1,167 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the generation kernel benchmark.
+ * See benchmark.h for the declarations.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "benchmark.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "lifeengine.h"
+#include "lifekernel.h"
+#include "strlib.h"
+#include "timer.h"
+
+using namespace std;
+
+const int BENCHMARK_MIN_SIZE = 1024;
+const long BENCHMARK_MIN_MS = 500;
+
+/*
+ * Repeat a colony in both directions until the board is at least
+ * BENCHMARK_MIN_SIZE cells high and wide.
+ * @param grid the colony to repeat
+ * @return the tiled board
+ */
+static CellBoard tileBoard(const CellBoard& grid) {
+    int copiesDown = (BENCHMARK_MIN_SIZE + grid.numRows() - 1) / grid.numRows();
+    int copiesAcross = (BENCHMARK_MIN_SIZE + grid.numCols() - 1) / grid.numCols();
+    CellBoard tiled(grid.numRows() * copiesDown, grid.numCols() * copiesAcross);
+    for (int r = 0; r < tiled.numRows(); r++) {
+        for (int c = 0; c < tiled.numCols(); c++) {
+            tiled.set(r, c, grid.get(r % grid.numRows(), c % grid.numCols()));
+        }
+    }
+    return tiled;
+}
+
+// the column buffers of the single-thread kernel, kept across generations so
+// that its timing does not include an allocation per generation
+static vector<uint64_t> kernelScratch;
+
+/*
+ * The ways of advancing a whole board that are compared.
+ */
+static void advanceReference(const CellBoard& src, CellBoard& dst) {
+    advanceRowsScalar(src, dst, 0, src.numRows());
+}
+
+static void advanceSingleThread(const CellBoard& src, CellBoard& dst) {
+    advanceRows(src, dst, 0, src.numRows(), kernelScratch);
+}
+
+static void advanceEngine(const CellBoard& src, CellBoard& dst) {
+    LifeEngine::advance(src, dst);
+}
+
+/*
+ * Run generations until at least BENCHMARK_MIN_MS have passed.
+ * @param board   the board to start from
+ * @param advance the function that computes one generation
+ * @return the number of cells advanced per second
+ */
+static double measure(const CellBoard& board, void (*advance)(const CellBoard&, CellBoard&)) {
+    CellBoard current = board;
+    CellBoard next(board.numRows(), board.numCols());
+    long generations = 0;
+    Timer timer(true);
+    do {
+        advance(current, next);
+        current.swap(next);
+        generations++;
+    } while (timer.elapsed() < BENCHMARK_MIN_MS);
+    long ms = timer.stop();
+    return (double) board.size() * generations * 1000.0 / ms;
+}
+
+void benchmarkKernels(const CellBoard& grid) {
+    if (grid.size() == 0) {
+        cout << "Nothing to benchmark on an empty board." << endl;
+        return;
+    }
+    CellBoard board = tileBoard(grid);
+    cout << "Benchmarking on a " << board.numRows() << "x" << board.numCols()
+         << " board (the current colony, tiled)..." << endl;
+
+    // one reference generation to check every kernel against
+    CellBoard expected(board.numRows(), board.numCols());
+    advanceRowsScalar(board, expected, 0, board.numRows());
+
+    double referenceRate = measure(board, advanceReference);
+    cout << setw(10) << left << "kernel" << setw(16) << right << "cells/second"
+         << setw(10) << "speedup" << endl;
+    cout << setw(10) << left << "cell" << setw(16) << right << fixed << setprecision(0)
+         << referenceRate << setw(9) << setprecision(1) << 1.0 << "x" << endl;
+
+    KernelKind original = getKernel();
+    for (int kind = KERNEL_SWAR; kind <= KERNEL_AVX2; kind++) {
+        if (!isKernelSupported((KernelKind) kind)) {
+            continue;
+        }
+        setKernel((KernelKind) kind);
+        CellBoard actual(board.numRows(), board.numCols());
+        advanceRows(board, actual, 0, board.numRows(), kernelScratch);
+        double rate = measure(board, advanceSingleThread);
+        cout << setw(10) << left << kernelName((KernelKind) kind)
+             << setw(16) << right << setprecision(0) << rate
+             << setw(9) << setprecision(1) << rate / referenceRate << "x";
+        if (actual != expected) {
+            cout << "  (MISMATCH with the per-cell rule!)";
+        }
+        cout << endl;
+    }
+    setKernel(original);
+
+    // how the parallel engine scales with the kernel picked at startup,
+    // recomputing the whole board in bands
+    Schedule originalSchedule = LifeEngine::getSchedule();
+    LifeEngine::setSchedule(SCHEDULE_BANDS);
+    int originalThreads = LifeEngine::getThreadCount();
+    LifeEngine::setThreadCount(0);
+    int maxThreads = std::max(originalThreads, LifeEngine::getThreadCount());
+    double singleRate = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        LifeEngine::setThreadCount(threads);
+        CellBoard actual(board.numRows(), board.numCols());
+        LifeEngine::advance(board, actual);
+        double rate = measure(board, advanceEngine);
+        if (threads == 1) {
+            singleRate = rate;
+        }
+        cout << setw(10) << left << (integerToString(threads) + (threads == 1 ? " thread" : " threads"))
+             << setw(16) << right << setprecision(0) << rate
+             << setw(9) << setprecision(1) << rate / singleRate << "x";
+        if (actual != expected) {
+            cout << "  (MISMATCH with the per-cell rule!)";
+        }
+        cout << endl;
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+
+    // the tile scheduler with all threads; the colony is tiled edge to
+    // edge, so this shows its overhead more than its skipping
+    LifeEngine::setSchedule(SCHEDULE_TILES);
+    CellBoard actual(board.numRows(), board.numCols());
+    LifeEngine::advance(board, actual);
+    double rate = measure(board, advanceEngine);
+    TileStats stats = LifeEngine::getTileStats();
+    cout << setw(10) << left << "tiles" << setw(16) << right << setprecision(0) << rate
+         << setw(9) << setprecision(1) << rate / singleRate << "x";
+    if (actual != expected) {
+        cout << "  (MISMATCH with the per-cell rule!)";
+    }
+    cout << endl;
+    cout << "  last generation: " << stats.processed << " of " << stats.tiles
+         << " tiles active, " << stats.steals << " of " << stats.tasks << " tasks stolen, "
+         << setprecision(2) << stats.idleMs << " ms idle over "
+         << stats.threads << " threads" << endl;
+    LifeEngine::setSchedule(originalSchedule);
+    LifeEngine::setThreadCount(originalThreads);
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
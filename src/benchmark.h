@@ -0,0 +1,24 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares a small benchmark for the generation kernels.
+ * See benchmark.cpp for the implementation.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _benchmark_h
+#define _benchmark_h
+
+#include "cellboard.h"
+
+/**
+ * Measures how many cells per second the per-cell reference rule and each
+ * supported bit-parallel kernel (swar, sse2, avx2) can advance, then how
+ * LifeEngine scales from 1 thread up to one per core and how the tile
+ * scheduler compares, and prints a table of the results to the console.
+ * The colony is tiled to at least BENCHMARK_MIN_SIZE rows and columns so
+ * that the vector kernels have full rows to work on.
+ */
+void benchmarkKernels(const CellBoard& grid);
+
+#endif // _benchmark_h
@@ -0,0 +1,641 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the functions that read and write boards in files.
+ * See boardfile.h for the documentation of each function.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "boardfile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+#include "error.h"
+#include "hashlife.h"
+#include "lifeengine.h"
+#include "strlib.h"
+#include "threadpool.h"
+
+using namespace std;
+
+const string SNAPSHOT_EXTENSION = ".snap";
+const string RLE_EXTENSION = ".rle";
+const string MACROCELL_EXTENSION = ".mc";
+
+// the longest line writeRleBoard writes, as other programs expect
+static const int RLE_LINE_LENGTH = 70;
+
+// loadTextBoard cuts a file into this many pieces per thread, so threads
+// that finish early can take another, but no piece is smaller than
+// TEXT_PIECE_MIN_BYTES
+static const int TEXT_PIECES_PER_THREAD = 4;
+static const size_t TEXT_PIECE_MIN_BYTES = 1 << 20;
+
+/*
+ * A whole file held in memory for reading: mapped where the platform has
+ * mmap, and read into a buffer otherwise.
+ */
+class MappedFile {
+public:
+    MappedFile(const string& filename, const string& caller) : bytes(nullptr), length(0) {
+#ifdef _WIN32
+        ifstream file(filename.c_str(), ios::binary | ios::ate);
+        if (!file) {
+            error(caller + ": cannot open " + filename);
+        }
+        buffer.resize((size_t) file.tellg());
+        file.seekg(0);
+        if (!buffer.empty() && !file.read(&buffer[0], buffer.size())) {
+            error(caller + ": cannot read " + filename);
+        }
+        bytes = buffer.empty() ? nullptr : &buffer[0];
+        length = buffer.size();
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error(caller + ": cannot open " + filename);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            error(caller + ": cannot read " + filename);
+        }
+        length = (size_t) info.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                error(caller + ": cannot map " + filename + " into memory");
+            }
+            // the file is read front to back, so let the kernel read ahead
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            bytes = (const char*) mapped;
+        }
+        close(fd);
+#endif // _WIN32
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (bytes) {
+            munmap((void*) bytes, length);
+        }
+#endif // _WIN32
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif // _WIN32
+
+    MappedFile(const MappedFile&);              // not copyable
+    MappedFile& operator =(const MappedFile&);
+};
+
+void readTextBoard(istream& input, CellBoard& board) {
+    int row = 0;
+    int col = 0;
+    board.resize(0, 0);
+    string line;
+    int count = 0;
+    while (getline(input, line)) {
+        if (count == 0) {
+            row = stringToInteger(line);
+        } else if (count == 1) {
+            col = stringToInteger(line);
+        } else {
+            if (board.size() == 0) {
+                board.resize(row, col);
+            }
+            int boardRow = count - 2;
+            for (int boardCol = 0; boardCol < (int) line.length(); boardCol++) {
+                board.set(boardRow, boardCol, CellBoard::fromChar(line[boardCol]));
+            }
+            if (count >= row + 1) {
+                break;
+            }
+        }
+        count++;
+    }
+}
+
+void writeTextBoard(ostream& output, const CellBoard& board) {
+    output << board.numRows() << '\n' << board.numCols() << '\n';
+    for (int r = 0; r < board.numRows(); r++) {
+        output << board.rowToString(r) << '\n';
+    }
+}
+
+/*
+ * Returns 1 in the low bit of each of the eight bytes in bytes that equals
+ * the matching byte of pattern, and 0 elsewhere.
+ */
+static uint64_t bytesEqual(uint64_t bytes, uint64_t pattern) {
+    const uint64_t LOW_SEVEN = 0x7f7f7f7f7f7f7f7fULL;
+    uint64_t diff = bytes ^ pattern;
+    return ~(((diff & LOW_SEVEN) + LOW_SEVEN) | diff | LOW_SEVEN) >> 7;
+}
+
+/*
+ * Packs one line of cells into a row of board, returning false if it is
+ * longer than the board is wide.  A \r left by Windows line endings is
+ * not a cell.
+ * Eight characters at a time are compared with X, O, and C as one 64-bit
+ * word, and the eight results gathered into a byte by one multiply.
+ */
+static bool packTextRow(const char* line, size_t length, CellBoard& board, int row) {
+    const uint64_t EVERY_BYTE = 0x0101010101010101ULL;
+    const uint64_t GATHER = 0x0102040810204080ULL;
+    if (length > 0 && line[length - 1] == '\r') {
+        length--;
+    }
+    if (length > (size_t) board.numCols()) {
+        return false;
+    }
+    uint64_t* high = board.highRow(row);
+    uint64_t* low = board.lowRow(row);
+    for (size_t start = 0; start < length; start += CellBoard::CELLS_PER_WORD) {
+        size_t end = min(length, start + CellBoard::CELLS_PER_WORD);
+        uint64_t highWord = 0;
+        uint64_t lowWord = 0;
+        size_t i = start;
+        for (; i + 8 <= end; i += 8) {
+            uint64_t bytes;
+            memcpy(&bytes, line + i, sizeof(bytes));
+            uint64_t alive = bytesEqual(bytes, 'X' * EVERY_BYTE);
+            uint64_t dying = bytesEqual(bytes, 'O' * EVERY_BYTE);
+            uint64_t decaying = bytesEqual(bytes, 'C' * EVERY_BYTE);
+            highWord |= ((alive | dying) * GATHER >> 56) << (i - start);
+            lowWord |= ((alive | decaying) * GATHER >> 56) << (i - start);
+        }
+        for (; i < end; i++) {
+            // X is ALIVE (both bits), O is DYING (high), C is DECAYING (low)
+            uint64_t alive = line[i] == 'X';
+            uint64_t dying = line[i] == 'O';
+            uint64_t decaying = line[i] == 'C';
+            highWord |= (alive | dying) << (i - start);
+            lowWord |= (alive | decaying) << (i - start);
+        }
+        high[start / CellBoard::CELLS_PER_WORD] = highWord;
+        low[start / CellBoard::CELLS_PER_WORD] = lowWord;
+    }
+    return true;
+}
+
+/*
+ * Returns the end of the line that starts at line: its \n, or end.
+ */
+static const char* lineEnd(const char* line, const char* end) {
+    const char* newline = (const char*) memchr(line, '\n', end - line);
+    return newline ? newline : end;
+}
+
+void loadTextBoard(const string& filename, CellBoard& board, int threads) {
+    MappedFile file(filename, "loadTextBoard");
+    const char* text = file.data();
+    const char* end = text + file.size();
+
+    // the two header lines, then the rows
+    board.resize(0, 0);
+    if (!text) {
+        return;
+    }
+    const char* rowsEnd = lineEnd(text, end);
+    if (rowsEnd == end) {
+        return;
+    }
+    const char* colsEnd = lineEnd(rowsEnd + 1, end);
+    if (colsEnd == end) {
+        return;
+    }
+    int rows = stringToInteger(string(text, rowsEnd));
+    int cols = stringToInteger(string(rowsEnd + 1, colsEnd));
+    const char* body = colsEnd + 1;
+    if (body == end) {
+        return;
+    }
+    board.resize(rows, cols);
+
+    // the body is cut into pieces of about equal size; counting the line
+    // breaks in each piece (in parallel) gives the row each piece starts
+    // in, and then each piece packs the rows that start in it
+    size_t bodySize = end - body;
+    int pieces = (int) min((size_t) max(1, threads) * TEXT_PIECES_PER_THREAD,
+                           bodySize / TEXT_PIECE_MIN_BYTES + 1);
+    vector<const char*> pieceStart(pieces + 1);
+    for (int i = 0; i <= pieces; i++) {
+        pieceStart[i] = body + bodySize * i / pieces;
+    }
+    ThreadPool pool(max(1, min(threads, pieces)));
+    vector<long long> firstRow(pieces + 1, 0);
+    pool.run(pieces, [&pieceStart, &firstRow](int piece) {
+        long long lines = 0;
+        const char* p = pieceStart[piece];
+        while ((p = (const char*) memchr(p, '\n', pieceStart[piece + 1] - p))) {
+            lines++;
+            p++;
+        }
+        firstRow[piece + 1] = lines;
+    });
+    for (int i = 1; i <= pieces; i++) {
+        firstRow[i] += firstRow[i - 1];
+    }
+
+    vector<long long> longRow(pieces, -1);
+    pool.run(pieces, [&](int piece) {
+        // a row that carries on from the piece before belongs to that piece
+        const char* line = pieceStart[piece];
+        long long row = firstRow[piece];
+        if (line != body && line[-1] != '\n') {
+            line = lineEnd(line, end);
+            row++;
+            if (line != end) {
+                line++;
+            }
+        }
+        while (line < pieceStart[piece + 1] && row < rows) {
+            const char* next = lineEnd(line, end);
+            if (!packTextRow(line, next - line, board, (int) row)) {
+                longRow[piece] = row;
+                return;
+            }
+            line = next + 1;
+            row++;
+        }
+    });
+    for (int i = 0; i < pieces; i++) {
+        if (longRow[i] >= 0) {
+            error("loadTextBoard: row " + integerToString((int) longRow[i] + 1) + " of " + filename
+                  + " has more than " + integerToString(cols) + " cells");
+        }
+    }
+}
+
+static const char SNAPSHOT_MAGIC[8] = {'L', 'I', 'F', 'E', 'S', 'N', 'A', 'P'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t RULE_DECAY = 0;
+
+/*
+ * The fixed-size start of a snapshot file.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t rule;
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t generation;
+    uint64_t reserved;
+};
+
+/*
+ * Checks a header read from the named file, returning the number of words
+ * in each bit plane.
+ */
+static size_t checkHeader(const string& filename, const SnapshotHeader& header, size_t fileSize) {
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        error("loadSnapshot: " + filename + " is not a board snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        error("loadSnapshot: " + filename + " is a snapshot of an unknown version");
+    }
+    if (header.rule != RULE_DECAY) {
+        error("loadSnapshot: " + filename + " uses a rule this program does not know");
+    }
+    if (header.rows > (uint32_t) INT32_MAX || header.cols > (uint32_t) INT32_MAX) {
+        error("loadSnapshot: " + filename + " has an impossible board size");
+    }
+    size_t words = ((size_t) header.cols + CellBoard::CELLS_PER_WORD - 1) / CellBoard::CELLS_PER_WORD;
+    size_t planeWords = (size_t) header.rows * words;
+    if (fileSize != sizeof(SnapshotHeader) + 2 * planeWords * sizeof(uint64_t)) {
+        error("loadSnapshot: " + filename + " is truncated or has extra data");
+    }
+    return planeWords;
+}
+
+/*
+ * Clears the bits past the last column of a board just loaded, in case
+ * the file had them set.
+ */
+static void clearPastLastColumn(CellBoard& board) {
+    int last = board.wordsPerRow() - 1;
+    uint64_t mask = board.lastWordMask();
+    for (int r = 0; r < board.numRows() && last >= 0; r++) {
+        board.highRow(r)[last] &= mask;
+        board.lowRow(r)[last] &= mask;
+    }
+}
+
+bool isSnapshotFile(const string& filename) {
+    ifstream file(filename.c_str(), ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    return file.read(magic, sizeof(magic)) && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+void loadSnapshot(const string& filename, CellBoard& board, uint64_t& generation) {
+    MappedFile file(filename, "loadSnapshot");
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        error("loadSnapshot: " + filename + " is not a board snapshot");
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    size_t planeWords = checkHeader(filename, header, file.size());
+    board.resize(header.rows, header.cols);
+    if (planeWords > 0) {
+        const char* planes = file.data() + sizeof(header);
+        memcpy(board.highRow(0), planes, planeWords * sizeof(uint64_t));
+        memcpy(board.lowRow(0), planes + planeWords * sizeof(uint64_t), planeWords * sizeof(uint64_t));
+    }
+    clearPastLastColumn(board);
+    generation = header.generation;
+}
+
+void saveSnapshot(const string& filename, const CellBoard& board, uint64_t generation) {
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.rule = RULE_DECAY;
+    header.rows = board.numRows();
+    header.cols = board.numCols();
+    header.generation = generation;
+    header.reserved = 0;
+
+    string temporary = filename + ".tmp";
+    ofstream file(temporary.c_str(), ios::binary | ios::trunc);
+    file.write((const char*) &header, sizeof(header));
+    size_t planeBytes = (size_t) board.numRows() * board.wordsPerRow() * sizeof(uint64_t);
+    if (planeBytes > 0) {
+        file.write((const char*) board.highRow(0), planeBytes);
+        file.write((const char*) board.lowRow(0), planeBytes);
+    }
+    file.close();
+    if (!file) {
+        remove(temporary.c_str());
+        error("saveSnapshot: cannot write " + temporary);
+    }
+#ifdef _WIN32
+    bool replaced = MoveFileExA(temporary.c_str(), filename.c_str(),
+                                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    // flush the data to disk before the rename makes it visible
+    int fd = open(temporary.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    bool replaced = rename(temporary.c_str(), filename.c_str()) == 0;
+#endif // _WIN32
+    if (!replaced) {
+        remove(temporary.c_str());
+        error("saveSnapshot: cannot replace " + filename);
+    }
+}
+
+void readBoardFile(const string& filename, CellBoard& board, uint64_t& generation) {
+    generation = 0;
+    if (isSnapshotFile(filename)) {
+        loadSnapshot(filename, board, generation);
+        return;
+    }
+    bool rle = endsWith(toLowerCase(filename), RLE_EXTENSION);
+    bool macrocell = endsWith(toLowerCase(filename), MACROCELL_EXTENSION);
+    if (!rle && !macrocell) {
+        loadTextBoard(filename, board, LifeEngine::getThreadCount());
+        return;
+    }
+    ifstream file(filename.c_str(), ios::binary);
+    if (!file) {
+        error("readBoardFile: cannot open " + filename);
+    }
+    if (rle) {
+        readRleBoard(file, board, generation);
+    } else {
+        HashLife hashLife;
+        generation = hashLife.readMacrocell(file);
+        hashLife.toBoard(board);
+    }
+}
+
+void writeBoardFile(const string& filename, const CellBoard& board, uint64_t generation) {
+    if (endsWith(toLowerCase(filename), SNAPSHOT_EXTENSION)) {
+        saveSnapshot(filename, board, generation);
+        return;
+    }
+    ofstream file(filename.c_str(), ios::binary);
+    if (endsWith(toLowerCase(filename), RLE_EXTENSION)) {
+        writeRleBoard(file, board, generation);
+    } else if (endsWith(toLowerCase(filename), MACROCELL_EXTENSION)) {
+        HashLife hashLife;
+        hashLife.load(board);
+        hashLife.writeMacrocell(file, generation);
+    } else {
+        writeTextBoard(file, board);
+    }
+    file.close();
+    if (!file) {
+        error("writeBoardFile: cannot write " + filename);
+    }
+}
+
+/*
+ * Reads the "x = COLS, y = ROWS, rule = ..." header of an RLE file, and any
+ * comment lines before it.
+ */
+static void readRleHeader(istream& input, int& rows, int& cols, uint64_t& generation) {
+    string line;
+    while (getline(input, line)) {
+        if (line.compare(0, 6, "#CXRLE") == 0) {
+            string::size_type gen = line.find("Gen=");
+            if (gen != string::npos) {
+                generation = strtoull(line.c_str() + gen + 4, nullptr, 10);
+            }
+        } else if (!line.empty() && line[0] != '#') {
+            break;
+        }
+    }
+    rows = -1;
+    cols = -1;
+    istringstream fields(line);
+    string field;
+    while (getline(fields, field, ',')) {
+        string::size_type equals = field.find('=');
+        if (equals == string::npos) {
+            continue;
+        }
+        string key = trim(field.substr(0, equals));
+        string value = trim(field.substr(equals + 1));
+        if (key == "x" && stringIsInteger(value)) {
+            cols = stringToInteger(value);
+        } else if (key == "y" && stringIsInteger(value)) {
+            rows = stringToInteger(value);
+        }
+    }
+    if (rows < 0 || cols < 0) {
+        error("readRleBoard: no \"x = COLS, y = ROWS\" header line");
+    }
+}
+
+void readRleBoard(istream& input, CellBoard& board, uint64_t& generation) {
+    generation = 0;
+    int rows;
+    int cols;
+    readRleHeader(input, rows, cols, generation);
+    board.resize(rows, cols);
+
+    int row = 0;
+    int col = 0;
+    long long count = 0;
+    char ch;
+    while (input.get(ch) && ch != '!') {
+        if (ch >= '0' && ch <= '9') {
+            count = count * 10 + (ch - '0');
+            if (count > INT32_MAX) {
+                error("readRleBoard: run too long");
+            }
+            continue;
+        }
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            continue;
+        }
+        int run = count > 0 ? (int) count : 1;
+        count = 0;
+        CellState state;
+        if (ch == '$') {
+            row += run;
+            col = 0;
+            continue;
+        } else if (ch == 'b' || ch == '.') {
+            state = EMPTY;
+        } else if (ch == 'o' || ch == 'A') {
+            state = ALIVE;
+        } else if (ch == 'B') {
+            state = DYING;
+        } else if (ch == 'C') {
+            state = DECAYING;
+        } else {
+            error(string("readRleBoard: unknown cell state '") + ch + "'");
+        }
+        if (state != EMPTY) {
+            if (row >= rows || (long long) col + run > cols) {
+                error("readRleBoard: the pattern is bigger than its x and y");
+            }
+            for (int i = 0; i < run; i++) {
+                board.set(row, col + i, state);
+            }
+        }
+        col += run;
+    }
+}
+
+/*
+ * Collects the runs of an RLE pattern and writes them in lines of at most
+ * RLE_LINE_LENGTH characters.
+ */
+class RleWriter {
+public:
+    RleWriter(ostream& output) : output(output) {
+        // empty
+    }
+
+    void add(int run, char tag) {
+        string item = run > 1 ? integerToString(run) + tag : string(1, tag);
+        if ((int) (line.length() + item.length()) > RLE_LINE_LENGTH) {
+            output << line << '\n';
+            line.clear();
+        }
+        line += item;
+    }
+
+    void finish() {
+        output << line << "!\n";
+    }
+
+private:
+    ostream& output;
+    string line;
+};
+
+void writeRleBoard(ostream& output, const CellBoard& board, uint64_t generation) {
+    if (generation > 0) {
+        output << "#CXRLE Gen=" << generation << '\n';
+    }
+    output << "x = " << board.numCols() << ", y = " << board.numRows() << ", rule = decay\n";
+    static const char TAGS[4] = {'.', 'C', 'B', 'A'};
+    RleWriter writer(output);
+    int pendingRows = 0;    // rows ended but not yet written
+    for (int r = 0; r < board.numRows(); r++) {
+        const uint64_t* high = board.highRow(r);
+        const uint64_t* low = board.lowRow(r);
+        int empties = 0;    // empty cells since the last run written
+        int run = 0;
+        CellState runState = EMPTY;
+        for (int c = 0; c < board.numCols(); ) {
+            int w = c / CellBoard::CELLS_PER_WORD;
+            if (c % CellBoard::CELLS_PER_WORD == 0 && (high[w] | low[w]) == 0) {
+                // a whole word of empty cells
+                int width = min(CellBoard::CELLS_PER_WORD, board.numCols() - c);
+                if (run > 0) {
+                    writer.add(run, TAGS[runState]);
+                    run = 0;
+                }
+                empties += width;
+                c += width;
+                continue;
+            }
+            CellState state = board.get(r, c);
+            if (state == EMPTY) {
+                if (run > 0) {
+                    writer.add(run, TAGS[runState]);
+                    run = 0;
+                }
+                empties++;
+            } else {
+                if (run > 0 && state != runState) {
+                    writer.add(run, TAGS[runState]);
+                    run = 0;
+                }
+                if (run == 0) {
+                    if (pendingRows > 0) {
+                        writer.add(pendingRows, '$');
+                        pendingRows = 0;
+                    }
+                    if (empties > 0) {
+                        writer.add(empties, '.');
+                        empties = 0;
+                    }
+                }
+                runState = state;
+                run++;
+            }
+            c++;
+        }
+        if (run > 0) {
+            writer.add(run, TAGS[runState]);
+        }
+        pendingRows++;
+    }
+    writer.finish();
+}
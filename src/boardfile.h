@@ -0,0 +1,119 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the functions that read and write boards in files.
+ * See boardfile.cpp for the implementation of each function.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _boardfile_h
+#define _boardfile_h
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "cellboard.h"
+
+/**
+ * Reads a board in the text format of the files in res/: the number of
+ * rows and the number of columns on lines of their own, then one line of
+ * cells per row, as written by CellBoard::rowToString.  Lines after the
+ * last row are ignored.
+ * If there are no rows of cells, board is left 0x0.
+ */
+void readTextBoard(std::istream& input, CellBoard& board);
+
+/**
+ * Loads the named file in the text format read by readTextBoard, using up
+ * to the given number of threads.
+ * The file is mapped into memory (or read whole where there is no mmap)
+ * and cut into pieces; the threads count the lines in each piece to find
+ * the row it starts in, and then pack the rows that start in each piece
+ * straight into the bit planes, so the rows of a large file are converted
+ * in parallel with no copying.  As with readTextBoard, lines after the
+ * last row are ignored.
+ * If the file cannot be read, or a row is longer than the board is wide,
+ * an error is thrown.
+ */
+void loadTextBoard(const std::string& filename, CellBoard& board, int threads);
+
+/**
+ * Writes a board in the text format read by readTextBoard.
+ */
+void writeTextBoard(std::ostream& output, const CellBoard& board);
+
+/**
+ * The file name extensions of the formats other than text.
+ */
+extern const std::string SNAPSHOT_EXTENSION;
+extern const std::string RLE_EXTENSION;
+extern const std::string MACROCELL_EXTENSION;
+
+/**
+ * Reads/writes a board in the format given by the file name extension:
+ * .rle for RLE, .mc for Macrocell, .snap for a snapshot, and the text
+ * format for anything else.  Snapshots are also recognized by their
+ * contents, whatever their name.  generation is the generation stored in
+ * the file, for the formats that have one, and 0 otherwise.  Text files
+ * are loaded by loadTextBoard with LifeEngine's number of threads.
+ * If the file cannot be read or written, or is not valid, an error is
+ * thrown.
+ */
+void readBoardFile(const std::string& filename, CellBoard& board, std::uint64_t& generation);
+void writeBoardFile(const std::string& filename, const CellBoard& board, std::uint64_t generation);
+
+/**
+ * Reads/writes a board in the run-length encoded (RLE) format used by
+ * Golly and most Life software.  The header line gives the size
+ * ("x = COLS, y = ROWS"), and the cells follow as runs: a count (1 if
+ * left out) and a state, where . or b is -, A or o is X, B is O, and C is
+ * C; $ ends a row and ! ends the pattern.  The generation can be given
+ * on a "#CXRLE Gen=N" line.
+ * The input is read one character at a time in a single pass, and only
+ * the runs of non-empty cells cost anything to store.
+ * If the input is not valid, an error is thrown.
+ */
+void readRleBoard(std::istream& input, CellBoard& board, std::uint64_t& generation);
+void writeRleBoard(std::ostream& output, const CellBoard& board, std::uint64_t generation);
+
+/**
+ * Board snapshots are a binary format that holds a board exactly as it is
+ * laid out in memory, so that it loads with no parsing at all:
+ *
+ *   bytes  0-7   the magic string "LIFESNAP"
+ *   bytes  8-11  the format version, 1
+ *   bytes 12-15  the rule, 0 for the decay rule (the only one so far)
+ *   bytes 16-19  the number of rows
+ *   bytes 20-23  the number of columns
+ *   bytes 24-31  the generation the board was saved at
+ *   bytes 32-39  reserved, 0
+ *   then the high bit plane and the low bit plane, each rows x
+ *   wordsPerRow 64-bit words (see CellBoard)
+ *
+ * Numbers are little-endian, the byte order of every machine the program
+ * is built for.
+ */
+
+/**
+ * Returns true if the named file starts with the snapshot magic string.
+ */
+bool isSnapshotFile(const std::string& filename);
+
+/**
+ * Loads a snapshot into board and sets generation to the generation it was
+ * saved at.  Where the platform has mmap, the file is mapped into memory
+ * and its bit planes are copied straight into the board.
+ * If the file is not a valid snapshot, an error is thrown.
+ */
+void loadSnapshot(const std::string& filename, CellBoard& board, std::uint64_t& generation);
+
+/**
+ * Saves board as a snapshot at the given generation.  The snapshot is
+ * written to a temporary file next to filename, which then replaces
+ * filename in one step, so a reader never sees half a file and a failed
+ * save leaves the old file in place.
+ * If the file cannot be written, an error is thrown.
+ */
+void saveSnapshot(const std::string& filename, const CellBoard& board, std::uint64_t generation);
+
+#endif // _boardfile_h
@@ -0,0 +1,197 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the CellBoard class.
+ * See cellboard.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "cellboard.h"
+#include <algorithm>
+#include "error.h"
+
+using namespace std;
+
+// defined here as well, for code that takes their address (std::min, say)
+const int CellBoard::CELLS_PER_WORD;
+const int CellBoard::TILE_ROWS;
+
+CellBoard::CellBoard(int rows, int cols)
+        : rows(0), cols(0), words(0), summaryValid(false) {
+    resize(rows, cols);
+}
+
+int CellBoard::numRows() const {
+    return rows;
+}
+
+int CellBoard::numCols() const {
+    return cols;
+}
+
+int CellBoard::wordsPerRow() const {
+    return words;
+}
+
+int64_t CellBoard::size() const {
+    return (int64_t) rows * cols;
+}
+
+void CellBoard::resize(int rows, int cols) {
+    if (rows < 0 || cols < 0) {
+        error("CellBoard::resize rows/cols cannot be negative");
+    }
+    this->rows = rows;
+    this->cols = cols;
+    words = (cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    highBits.assign((size_t) rows * words, 0);
+    lowBits.assign((size_t) rows * words, 0);
+    discardTileSummary();
+}
+
+void CellBoard::clear() {
+    std::fill(highBits.begin(), highBits.end(), 0);
+    std::fill(lowBits.begin(), lowBits.end(), 0);
+    discardTileSummary();
+}
+
+bool CellBoard::inBounds(int r, int c) const {
+    return r >= 0 && r < rows && c >= 0 && c < cols;
+}
+
+CellState CellBoard::get(int r, int c) const {
+    if (!inBounds(r, c)) {
+        error("CellBoard::get illegal row/col");
+    }
+    size_t index = (size_t) r * words + c / CELLS_PER_WORD;
+    int bit = c % CELLS_PER_WORD;
+    int high = (highBits[index] >> bit) & 1;
+    int low = (lowBits[index] >> bit) & 1;
+    return (CellState) (high << 1 | low);
+}
+
+void CellBoard::set(int r, int c, CellState state) {
+    if (!inBounds(r, c)) {
+        error("CellBoard::set illegal row/col");
+    }
+    summaryValid = false;
+    size_t index = (size_t) r * words + c / CELLS_PER_WORD;
+    uint64_t mask = uint64_t(1) << (c % CELLS_PER_WORD);
+    if (state & 2) {
+        highBits[index] |= mask;
+    } else {
+        highBits[index] &= ~mask;
+    }
+    if (state & 1) {
+        lowBits[index] |= mask;
+    } else {
+        lowBits[index] &= ~mask;
+    }
+}
+
+bool CellBoard::isOccupied(int r, int c) const {
+    if (!inBounds(r, c)) {
+        error("CellBoard::isOccupied illegal row/col");
+    }
+    size_t index = (size_t) r * words + c / CELLS_PER_WORD;
+    return (highBits[index] >> (c % CELLS_PER_WORD)) & 1;
+}
+
+int64_t CellBoard::count(CellState state) const {
+    int64_t total = 0;
+    for (size_t i = 0; i < highBits.size(); i++) {
+        uint64_t high = (state & 2) ? highBits[i] : ~highBits[i];
+        uint64_t low = (state & 1) ? lowBits[i] : ~lowBits[i];
+        total += popcount64(high & low);
+    }
+    if (state == EMPTY) {
+        // padding bits past the last column read as empty; don't count them
+        total -= (int64_t) rows * (words * CELLS_PER_WORD - cols);
+    }
+    return total;
+}
+
+string CellBoard::rowToString(int r) const {
+    string row(cols, '-');
+    for (int c = 0; c < cols; c++) {
+        row[c] = toChar(get(r, c));
+    }
+    return row;
+}
+
+uint64_t CellBoard::lastWordMask() const {
+    int used = cols % CELLS_PER_WORD;
+    return used == 0 ? ~uint64_t(0) : (uint64_t(1) << used) - 1;
+}
+
+int CellBoard::numTileRows() const {
+    return (rows + TILE_ROWS - 1) / TILE_ROWS;
+}
+
+int CellBoard::numTileCols() const {
+    return words;
+}
+
+bool CellBoard::hasTileSummary() const {
+    return summaryValid;
+}
+
+const vector<unsigned char>& CellBoard::tileSummary() const {
+    return summary;
+}
+
+void CellBoard::setTileSummary(vector<unsigned char>& summary) {
+    if ((int) summary.size() != numTileRows() * numTileCols()) {
+        error("CellBoard::setTileSummary wrong number of tiles");
+    }
+    this->summary.swap(summary);
+    summaryValid = true;
+}
+
+void CellBoard::discardTileSummary() {
+    summaryValid = false;
+}
+
+void CellBoard::swap(CellBoard& other) {
+    std::swap(rows, other.rows);
+    std::swap(cols, other.cols);
+    std::swap(words, other.words);
+    highBits.swap(other.highBits);
+    lowBits.swap(other.lowBits);
+    summary.swap(other.summary);
+    std::swap(summaryValid, other.summaryValid);
+}
+
+bool CellBoard::operator ==(const CellBoard& other) const {
+    return rows == other.rows && cols == other.cols
+            && highBits == other.highBits && lowBits == other.lowBits;
+}
+
+bool CellBoard::operator !=(const CellBoard& other) const {
+    return !(*this == other);
+}
+
+char CellBoard::toChar(CellState state) {
+    switch (state) {
+    case ALIVE:
+        return 'X';
+    case DYING:
+        return 'O';
+    case DECAYING:
+        return 'C';
+    default:
+        return '-';
+    }
+}
+
+CellState CellBoard::fromChar(char ch) {
+    if (ch == 'X') {
+        return ALIVE;
+    } else if (ch == 'O') {
+        return DYING;
+    } else if (ch == 'C') {
+        return DECAYING;
+    } else {
+        return EMPTY;
+    }
+}
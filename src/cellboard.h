@@ -0,0 +1,217 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the CellBoard class, a compact store for the
+ * simulation grid.
+ * See cellboard.cpp for the implementation of each member.
+ *
+ * Every cell holds one of four decay states packed into two bits.
+ * The bits are kept "bit-sliced": each row owns a run of 64-bit words
+ * holding the high bit of 64 consecutive cells, and a matching run of words
+ * holding the low bit.  The encoding is chosen so that a live or dying cell
+ * (X or O) is exactly a cell whose high bit is set, and so that ageing
+ * (X -> O -> C -> -) is a decrement.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _cellboard_h
+#define _cellboard_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * The four states a cell can be in, in the order a cell decays.
+ */
+enum CellState {
+    EMPTY = 0,      // "-"
+    DECAYING = 1,   // "C"
+    DYING = 2,      // "O"
+    ALIVE = 3       // "X"
+};
+
+/**
+ * Flags kept for each tile in a board's tile summary.
+ */
+enum TileFlag {
+    TILE_NON_EMPTY = 1,     // some cell in the tile is X, O, or C
+    TILE_OCCUPIED = 2       // some cell in the tile is X or O
+};
+
+/**
+ * Returns the number of set bits in the given word.
+ */
+inline int popcount64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word) {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * The CellBoard class is a rows x cols grid of CellStates stored as two
+ * bit planes.  Bit (c % 64) of word (c / 64) in a row belongs to column c;
+ * bits past the last column are always zero.
+ */
+class CellBoard {
+public:
+    /**
+     * Number of cells held by each word of a bit plane.
+     */
+    static const int CELLS_PER_WORD = 64;
+
+    /**
+     * Number of rows in a tile of the tile summary.  A tile is one word
+     * (64 columns) wide, so tiles are 64x64 cells.
+     */
+    static const int TILE_ROWS = 64;
+
+    /**
+     * Creates a board of the given size with every cell EMPTY.
+     */
+    CellBoard(int rows = 0, int cols = 0);
+
+    /**
+     * Returns the number of rows/columns in the board.
+     */
+    int numRows() const;
+    int numCols() const;
+
+    /**
+     * Returns the number of 64-bit words used by one row of one bit plane.
+     */
+    int wordsPerRow() const;
+
+    /**
+     * Returns rows * cols.
+     */
+    std::int64_t size() const;
+
+    /**
+     * Changes the dimensions of the board and sets every cell to EMPTY.
+     */
+    void resize(int rows, int cols);
+
+    /**
+     * Sets every cell to EMPTY without changing the dimensions.
+     */
+    void clear();
+
+    /**
+     * Returns true if (r, c) lies inside the board.
+     */
+    bool inBounds(int r, int c) const;
+
+    /**
+     * Returns/sets the state of the cell at (r, c).
+     * If the location given is not in bounds, an error is thrown.
+     */
+    CellState get(int r, int c) const;
+    void set(int r, int c, CellState state);
+
+    /**
+     * Returns true if the cell at (r, c) is alive or dying (X or O).
+     * These are the cells that count as neighbors.
+     */
+    bool isOccupied(int r, int c) const;
+
+    /**
+     * Returns the number of cells in the given state.
+     */
+    std::int64_t count(CellState state) const;
+
+    /**
+     * Returns one row of the board in the text format used by the
+     * input files, e.g. "--XO-C".
+     */
+    std::string rowToString(int r) const;
+
+    /**
+     * Direct access to the words of one row of the high/low bit plane.
+     * Generation kernels use these to work on 64 cells at a time; callers
+     * must keep the bits past the last column zero, and must call
+     * discardTileSummary before writing through these pointers.
+     */
+    const std::uint64_t* highRow(int r) const;
+    std::uint64_t* highRow(int r);
+    const std::uint64_t* lowRow(int r) const;
+    std::uint64_t* lowRow(int r);
+
+    /**
+     * Returns the mask of valid bits in the last word of every row.
+     */
+    std::uint64_t lastWordMask() const;
+
+    /**
+     * Returns the number of tile rows/columns in the tile summary.
+     */
+    int numTileRows() const;
+    int numTileCols() const;
+
+    /**
+     * The tile summary is an optional cache of TileFlags, one byte per
+     * tile in row-major order (numTileCols() tiles per tile row), that
+     * lets the tile scheduler skip empty parts of the board without
+     * reading them.
+     * It is filled in by whoever computed the board and is thrown away by
+     * any change made through set, resize, or clear.
+     */
+    bool hasTileSummary() const;
+    const std::vector<unsigned char>& tileSummary() const;
+    void setTileSummary(std::vector<unsigned char>& summary);
+    void discardTileSummary();
+
+    /**
+     * Exchanges the contents of two boards in constant time.
+     */
+    void swap(CellBoard& other);
+
+    bool operator ==(const CellBoard& other) const;
+    bool operator !=(const CellBoard& other) const;
+
+    /**
+     * Converts between cell states and the characters used by the
+     * input files and console output.
+     * Any character other than X, O, or C is read as an EMPTY cell.
+     */
+    static char toChar(CellState state);
+    static CellState fromChar(char ch);
+
+private:
+    int rows;
+    int cols;
+    int words;
+    std::vector<std::uint64_t> highBits;
+    std::vector<std::uint64_t> lowBits;
+    std::vector<unsigned char> summary;
+    bool summaryValid;
+};
+
+/*
+ * The row accessors are defined here so that the generation kernels can
+ * inline them; they are called for every row of every generation.
+ */
+inline const std::uint64_t* CellBoard::highRow(int r) const {
+    return highBits.data() + (size_t) r * words;
+}
+
+inline std::uint64_t* CellBoard::highRow(int r) {
+    return highBits.data() + (size_t) r * words;
+}
+
+inline const std::uint64_t* CellBoard::lowRow(int r) const {
+    return lowBits.data() + (size_t) r * words;
+}
+
+inline std::uint64_t* CellBoard::lowRow(int r) {
+    return lowBits.data() + (size_t) r * words;
+}
+
+#endif // _cellboard_h
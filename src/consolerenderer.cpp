@@ -0,0 +1,137 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the ConsoleRenderer class.
+ * See consolerenderer.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "consolerenderer.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace std;
+
+// unchanged cells up to this many are written over rather than skipped
+// with a cursor movement, which takes about as many bytes
+static const int MAX_OVERWRITE = 8;
+
+ConsoleRenderer::ConsoleRenderer()
+        : previous(0, 0), drawn(false), cursorRow(0), cursorCol(0), bytesWritten(0) {
+    // empty
+}
+
+bool ConsoleRenderer::isSupported() {
+#if defined(SPL_HEADLESS_MODE) && !defined(_WIN32)
+    const char* term = getenv("TERM");
+    return isatty(STDOUT_FILENO) && term && strcmp(term, "dumb") != 0;
+#else
+    return false;
+#endif
+}
+
+void ConsoleRenderer::render(const CellBoard& grid) {
+    buffer.clear();
+    if (!drawn || previous.numRows() != grid.numRows() || previous.numCols() != grid.numCols()) {
+        // home the cursor and clear the screen, then draw every row
+        buffer.reserve((size_t) (grid.numCols() + 1) * grid.numRows() + 16);
+        buffer += "\033[H\033[2J";
+        for (int r = 0; r < grid.numRows(); r++) {
+            buffer += grid.rowToString(r);
+            buffer += '\n';
+        }
+        cursorRow = grid.numRows();
+        cursorCol = 0;
+        drawn = true;
+    } else {
+        for (int r = 0; r < grid.numRows(); r++) {
+            size_t rowStart = buffer.size();
+            int startRow = cursorRow;
+            int startCol = cursorCol;
+            const uint64_t* high = grid.highRow(r);
+            const uint64_t* low = grid.lowRow(r);
+            const uint64_t* oldHigh = previous.highRow(r);
+            const uint64_t* oldLow = previous.lowRow(r);
+            for (int w = 0; w < grid.wordsPerRow(); w++) {
+                uint64_t changed = (high[w] ^ oldHigh[w]) | (low[w] ^ oldLow[w]);
+                while (changed) {
+                    int bit = popcount64((changed & (~changed + 1)) - 1);
+                    changed &= changed - 1;
+                    int c = w * CellBoard::CELLS_PER_WORD + bit;
+                    moveTo(r, c, grid);
+                    buffer += CellBoard::toChar(grid.get(r, c));
+                    cursorCol++;
+                }
+            }
+            // a row with changes all over is cheaper to write out whole
+            if (buffer.size() - rowStart > (size_t) grid.numCols() + MAX_OVERWRITE) {
+                buffer.resize(rowStart);
+                cursorRow = startRow;
+                cursorCol = startCol;
+                moveTo(r, 0, grid);
+                buffer += grid.rowToString(r);
+                cursorCol = grid.numCols();
+            }
+        }
+    }
+    previous = grid;
+    cout.write(buffer.data(), buffer.size());
+    cout.flush();
+    bytesWritten += buffer.size();
+}
+
+void ConsoleRenderer::finish() {
+    if (drawn) {
+        buffer.clear();
+        moveTo(previous.numRows(), 0, previous);
+        cout.write(buffer.data(), buffer.size());
+        cout.flush();
+        bytesWritten += buffer.size();
+    }
+    drawn = false;
+}
+
+size_t ConsoleRenderer::getBytesWritten() const {
+    return bytesWritten;
+}
+
+/*
+ * Adds to the buffer what it takes to get the cursor to the given cell:
+ * nothing if it is there, the cells in between if it is a little way to
+ * the left of it on the same row, and an escape sequence otherwise.
+ */
+void ConsoleRenderer::moveTo(int row, int col, const CellBoard& grid) {
+    if (row == cursorRow && col >= cursorCol && col - cursorCol <= MAX_OVERWRITE) {
+        for (; cursorCol < col; cursorCol++) {
+            buffer += CellBoard::toChar(grid.get(row, cursorCol));
+        }
+        return;
+    }
+    // rows and columns in escape sequences count from 1
+    buffer += "\033[";
+    appendNumber(row + 1);
+    buffer += ';';
+    appendNumber(col + 1);
+    buffer += 'H';
+    cursorRow = row;
+    cursorCol = col;
+}
+
+/*
+ * Adds the decimal digits of a non-negative number to the buffer.
+ */
+void ConsoleRenderer::appendNumber(int n) {
+    char digits[12];
+    int length = 0;
+    do {
+        digits[length++] = (char) ('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (length > 0) {
+        buffer += digits[--length];
+    }
+}
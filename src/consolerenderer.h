@@ -0,0 +1,77 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the ConsoleRenderer class, which animates a board in
+ * a text terminal by redrawing only the cells that change.
+ * See consolerenderer.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _consolerenderer_h
+#define _consolerenderer_h
+
+#include <cstddef>
+#include <string>
+#include "cellboard.h"
+
+/**
+ * The ConsoleRenderer class draws the frames of an animation in a terminal
+ * that understands ANSI escape sequences.  The first frame is drawn in
+ * full at the top of a cleared screen; after that the renderer compares
+ * each frame with the one before, a 64-cell word at a time, and writes
+ * only the cells that changed, moving the cursor to them with escape
+ * sequences (or, when that is shorter, writing over the few unchanged
+ * cells in between).  A frame is built in a buffer kept from frame to
+ * frame and written with one flush, so a quiet colony costs a few bytes a
+ * frame instead of the whole board.
+ *
+ * Rows longer than the terminal is wide wrap around and break the cursor
+ * addressing, so the renderer is meant for boards that fit on the screen.
+ */
+class ConsoleRenderer {
+public:
+    /**
+     * Creates a renderer that has drawn nothing yet.
+     */
+    ConsoleRenderer();
+
+    /**
+     * Returns true if standard output is a terminal that the renderer can
+     * draw on.  That is only the case in a headless build (the Stanford
+     * console window does not understand escape sequences), on a system
+     * with ANSI terminals, and when output is not redirected to a file.
+     */
+    static bool isSupported();
+
+    /**
+     * Draws grid, as a whole frame the first time or when its size has
+     * changed, and otherwise as the cells that differ from the last frame.
+     */
+    void render(const CellBoard& grid);
+
+    /**
+     * Moves the cursor to the line after the frame, so that the output
+     * that follows starts below it, and forgets the frame, so that the
+     * next call to render draws a whole frame again.
+     */
+    void finish();
+
+    /**
+     * Returns the number of bytes written to the terminal since the
+     * renderer was created.
+     */
+    std::size_t getBytesWritten() const;
+
+private:
+    void moveTo(int row, int col, const CellBoard& grid);
+    void appendNumber(int n);
+
+    CellBoard previous;         // the frame on the screen
+    bool drawn;                 // false if previous is not on the screen
+    std::string buffer;         // the bytes of the frame being built
+    int cursorRow;              // where the cursor is, in cells of the frame
+    int cursorCol;
+    std::size_t bytesWritten;
+};
+
+#endif // _consolerenderer_h
@@ -0,0 +1,110 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the DensityMap class.
+ * See densitymap.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "densitymap.h"
+#include <algorithm>
+#include <utility>
+#include "error.h"
+
+using namespace std;
+
+/*
+ * Returns the number of set bits in each byte of a word, in that byte.
+ */
+static inline uint64_t bytePopcounts(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+}
+
+DensityMap::DensityMap() {
+    // empty
+}
+
+void DensityMap::build(const CellBoard& board) {
+    levels.clear();
+    rows.clear();
+    cols.clear();
+    if (board.size() == 0) {
+        return;
+    }
+
+    // level 0: a word of byte counts adds up to at most 3 * 8 per row, or
+    // 3 * 64 over a block, so a block's weight never carries into the next
+    int blockRows = (board.numRows() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int blockCols = board.wordsPerRow() * (CellBoard::CELLS_PER_WORD / BLOCK_SIZE);
+    levels.emplace_back((size_t) blockRows * blockCols);
+    rows.push_back(blockRows);
+    cols.push_back(blockCols);
+    vector<uint32_t>& base = levels.back();
+    for (int br = 0; br < blockRows; br++) {
+        int top = br * BLOCK_SIZE;
+        int bottom = min(top + BLOCK_SIZE, board.numRows());
+        for (int w = 0; w < board.wordsPerRow(); w++) {
+            uint64_t sums = 0;
+            for (int r = top; r < bottom; r++) {
+                sums += 2 * bytePopcounts(board.highRow(r)[w]) + bytePopcounts(board.lowRow(r)[w]);
+            }
+            uint32_t* block = &base[(size_t) br * blockCols + w * (CellBoard::CELLS_PER_WORD / BLOCK_SIZE)];
+            for (int b = 0; b < CellBoard::CELLS_PER_WORD / BLOCK_SIZE; b++) {
+                block[b] = (uint32_t) (sums >> (8 * b)) & 0xff;
+            }
+        }
+    }
+
+    // each level after that sums four blocks of the one before
+    while (rows.back() > 1 || cols.back() > 1) {
+        int lowerRows = rows.back();
+        int lowerCols = cols.back();
+        int upperRows = (lowerRows + 1) / 2;
+        int upperCols = (lowerCols + 1) / 2;
+        vector<uint32_t> upper((size_t) upperRows * upperCols, 0);
+        const vector<uint32_t>& lower = levels.back();
+        for (int r = 0; r < lowerRows; r++) {
+            for (int c = 0; c < lowerCols; c++) {
+                upper[(size_t) (r / 2) * upperCols + c / 2] += lower[(size_t) r * lowerCols + c];
+            }
+        }
+        levels.push_back(std::move(upper));
+        rows.push_back(upperRows);
+        cols.push_back(upperCols);
+    }
+}
+
+int DensityMap::numLevels() const {
+    return (int) levels.size();
+}
+
+int DensityMap::numRows(int level) const {
+    return rows[level];
+}
+
+int DensityMap::numCols(int level) const {
+    return cols[level];
+}
+
+uint32_t DensityMap::weight(int level, int row, int col) const {
+    if (level < 0 || level >= numLevels() || row < 0 || row >= rows[level]
+            || col < 0 || col >= cols[level]) {
+        error("DensityMap::weight illegal level/row/col");
+    }
+    return levels[level][(size_t) row * cols[level] + col];
+}
+
+uint32_t DensityMap::blockWeight(const CellBoard& board, int top, int left, int size) {
+    int w = left / CellBoard::CELLS_PER_WORD;
+    int shift = left % CellBoard::CELLS_PER_WORD;
+    uint64_t mask = size >= CellBoard::CELLS_PER_WORD ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+    int bottom = min(top + size, board.numRows());
+    uint32_t sum = 0;
+    for (int r = top; r < bottom; r++) {
+        sum += 2 * popcount64((board.highRow(r)[w] >> shift) & mask)
+                + popcount64((board.lowRow(r)[w] >> shift) & mask);
+    }
+    return sum;
+}
@@ -0,0 +1,81 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the DensityMap class, a mipmap of how full the blocks
+ * of a board are, for drawing boards with more cells than pixels.
+ * See densitymap.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _densitymap_h
+#define _densitymap_h
+
+#include <cstdint>
+#include <vector>
+#include "cellboard.h"
+
+/**
+ * The DensityMap class sums up a board in square blocks of cells, with
+ * each cell weighing 0 if it is EMPTY, 1 if it is DECAYING, 2 if it is
+ * DYING and 3 if it is ALIVE (the value of its two bits, high bit 2).
+ * Level 0 has blocks of BLOCK_SIZE x BLOCK_SIZE cells, and each level
+ * after it has blocks twice as wide as the one before, each the sum of
+ * four blocks of that level, up to one block covering the whole board.
+ *
+ * Level 0 is counted straight from the bit planes: the bits in each byte
+ * of a row word are counted in parallel, eight bytes at once, and the
+ * counts of BLOCK_SIZE rows added up in the same word, so the whole map
+ * costs a few operations per 64 cells.  A block that is a pixel in a
+ * zoomed-out view is then a single lookup, however many cells it covers.
+ */
+class DensityMap {
+public:
+    /**
+     * The number of cells on a side of a level 0 block.
+     */
+    static const int BLOCK_SIZE = 8;
+
+    /**
+     * Creates a map of a 0x0 board.
+     */
+    DensityMap();
+
+    /**
+     * Replaces the map with one of the given board.
+     */
+    void build(const CellBoard& board);
+
+    /**
+     * Returns the number of levels, 0 for a map of a 0x0 board.
+     */
+    int numLevels() const;
+
+    /**
+     * Returns the number of rows/columns of blocks at the given level;
+     * blocks at the edges may stick out past the board.
+     */
+    int numRows(int level) const;
+    int numCols(int level) const;
+
+    /**
+     * Returns the weight of the cells in the block at the given row and
+     * column of blocks of a level.  If the location given is not in
+     * bounds, an error is thrown.
+     */
+    std::uint32_t weight(int level, int row, int col) const;
+
+    /**
+     * Returns the weight of the size x size cells of board whose top-left
+     * cell is (top, left), straight from the board.  size must be a power
+     * of two no more than 64 and left a multiple of it, so that the block
+     * lies within one word of each row; rows past the board count as empty.
+     */
+    static std::uint32_t blockWeight(const CellBoard& board, int top, int left, int size);
+
+private:
+    std::vector<std::vector<std::uint32_t>> levels;     // blocks of each level, row by row
+    std::vector<int> rows;                              // rows/columns of blocks of each level
+    std::vector<int> cols;
+};
+
+#endif // _densitymap_h
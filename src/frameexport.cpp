@@ -0,0 +1,453 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the frame exporter.
+ * See frameexport.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "frameexport.h"
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+#include "error.h"
+
+using namespace std;
+
+// the RGB colors of the cell states, as in the GUI: -, C, O, X
+static const unsigned char STATE_RGB[4][3] = {
+    {0xff, 0xff, 0xff}, {0xd3, 0xd3, 0xd3}, {0x69, 0x69, 0x69}, {0x00, 0x00, 0x00}
+};
+
+// compressed bytes gathered before they are written as an IDAT chunk
+static const size_t PNG_CHUNK_BYTES = 1 << 16;
+
+// the digits of a frame number in a file name
+static const int FRAME_NUMBER_DIGITS = 6;
+
+/*
+ * Returns the width and height in pixels of an image of board, throwing
+ * an error if either is too large for an image file.
+ */
+static void imageSize(const CellBoard& board, int scale, int& width, int& height) {
+    if (scale < 1 || (long long) board.numCols() * scale > INT_MAX
+            || (long long) board.numRows() * scale > INT_MAX) {
+        error("the image of the board is too large");
+    }
+    width = board.numCols() * scale;
+    height = board.numRows() * scale;
+}
+
+/*
+ * Draws row r of board into pixels, one state (0 to 3) per pixel, each
+ * cell scale pixels wide.
+ */
+static void drawRow(const CellBoard& board, int r, int scale, vector<unsigned char>& pixels) {
+    const uint64_t* high = board.highRow(r);
+    const uint64_t* low = board.lowRow(r);
+    size_t x = 0;
+    for (int c = 0; c < board.numCols(); c++) {
+        int w = c / CellBoard::CELLS_PER_WORD;
+        int bit = c % CellBoard::CELLS_PER_WORD;
+        unsigned char state = (unsigned char) (((high[w] >> bit) & 1) << 1 | ((low[w] >> bit) & 1));
+        for (int i = 0; i < scale; i++) {
+            pixels[x++] = state;
+        }
+    }
+}
+
+/*
+ * Writes a 32-bit number with its most significant byte first, as PNG
+ * stores them.
+ */
+static void appendBigEndian(string& bytes, uint32_t value) {
+    bytes += (char) (value >> 24);
+    bytes += (char) (value >> 16);
+    bytes += (char) (value >> 8);
+    bytes += (char) value;
+}
+
+/*
+ * Returns the table of the CRC-32 of each byte.
+ */
+static vector<uint32_t> makeCrcTable() {
+    vector<uint32_t> table(256);
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+/*
+ * Returns the CRC-32 of some bytes, as PNG chunks end with.
+ */
+static uint32_t pngCrc(const string& bytes) {
+    static const vector<uint32_t> table = makeCrcTable();
+    uint32_t crc = 0xffffffffu;
+    for (char ch : bytes) {
+        crc = table[(crc ^ (unsigned char) ch) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+/*
+ * Writes a PNG chunk: its length, type, data and CRC.
+ */
+static void writeChunk(ostream& output, const char* type, const string& data) {
+    string chunk(type, 4);
+    chunk += data;
+    string length;
+    appendBigEndian(length, (uint32_t) data.size());
+    string crc;
+    appendBigEndian(crc, pngCrc(chunk));
+    output << length << chunk << crc;
+}
+
+/*
+ * A zlib stream of one deflate block with the fixed Huffman codes, in
+ * which the only back-references are to the byte just before, so it
+ * compresses runs of a byte and nothing else.  The compressed bytes build
+ * up in a string for the caller to take.
+ */
+class RunDeflater {
+public:
+    RunDeflater() : bits(0), bitCount(0), last(-1), repeats(0), adlerLow(1), adlerHigh(0), adlerBytes(0) {
+        output += (char) 0x78;     // deflate, 32K window, no dictionary
+        output += (char) 0x01;
+        writeBits(1, 1);           // the last block
+        writeBits(1, 2);           // with the fixed codes
+    }
+
+    /*
+     * Compresses the next byte.
+     */
+    void put(unsigned char byte) {
+        adlerLow += byte;
+        adlerHigh += adlerLow;
+        if (++adlerBytes == 5552) {     // the most bytes before the sums can overflow
+            adlerLow %= 65521;
+            adlerHigh %= 65521;
+            adlerBytes = 0;
+        }
+        if (byte == last) {
+            if (++repeats == MAX_MATCH) {
+                writeRepeats();
+            }
+            return;
+        }
+        writeRepeats();
+        writeSymbol(byte);
+        last = byte;
+    }
+
+    /*
+     * Ends the block and the stream.
+     */
+    void finish() {
+        writeRepeats();
+        writeSymbol(256);
+        if (bitCount > 0) {
+            output += (char) bits;
+        }
+        bits = 0;
+        bitCount = 0;
+        appendBigEndian(output, (uint32_t) ((adlerHigh % 65521) << 16 | (adlerLow % 65521)));
+    }
+
+    string output;              // compressed bytes not yet taken
+
+private:
+    static const int MAX_MATCH = 258;
+
+    /*
+     * Adds the low count bits of value to the stream, first bit first.
+     */
+    void writeBits(uint32_t value, int count) {
+        bits |= value << bitCount;
+        bitCount += count;
+        while (bitCount >= 8) {
+            output += (char) bits;
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    /*
+     * Adds a Huffman code, which deflate stores starting from its most
+     * significant bit.
+     */
+    void writeCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed = reversed << 1 | ((code >> i) & 1);
+        }
+        writeBits(reversed, length);
+    }
+
+    /*
+     * Adds a literal byte (0-255), the end of the block (256), or a
+     * length code (257-285) in the fixed Huffman code.
+     */
+    void writeSymbol(int symbol) {
+        if (symbol < 144) {
+            writeCode(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            writeCode(0x190 + symbol - 144, 9);
+        } else if (symbol < 280) {
+            writeCode(symbol - 256, 7);
+        } else {
+            writeCode(0xc0 + symbol - 280, 8);
+        }
+    }
+
+    /*
+     * Adds the repeats of the last byte counted so far, as a copy of the
+     * byte before if there are enough of them and as literals otherwise.
+     */
+    void writeRepeats() {
+        static const int LENGTH_BASE[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        static const int LENGTH_EXTRA[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        if (repeats < 3) {
+            for (int i = 0; i < repeats; i++) {
+                writeSymbol(last);
+            }
+        } else {
+            int code = 28;
+            while (LENGTH_BASE[code] > repeats) {
+                code--;
+            }
+            writeSymbol(257 + code);
+            writeBits(repeats - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+            writeBits(0, 5);        // distance code 0: one byte back
+        }
+        repeats = 0;
+    }
+
+    uint32_t bits;              // bits not yet made into a byte
+    int bitCount;
+    int last;                   // the last byte written as a literal, or -1
+    int repeats;                // repeats of it not yet written
+    uint32_t adlerLow;          // the Adler-32 checksum of the bytes put
+    uint32_t adlerHigh;
+    int adlerBytes;
+};
+
+void writePngImage(ostream& output, const CellBoard& board, int scale) {
+    int width = 0;
+    int height = 0;
+    imageSize(board, scale, width, height);
+    output << "\x89PNG\r\n\x1a\n";
+    string header;
+    appendBigEndian(header, (uint32_t) width);
+    appendBigEndian(header, (uint32_t) height);
+    header += (char) 2;         // two bits a pixel
+    header += (char) 3;         // from a palette
+    header += string(3, '\0');  // deflated, filtered by row, not interlaced
+    writeChunk(output, "IHDR", header);
+    string palette;
+    for (int state = EMPTY; state <= ALIVE; state++) {
+        palette.append((const char*) STATE_RGB[state], 3);
+    }
+    writeChunk(output, "PLTE", palette);
+
+    // each image row is a filter byte and four pixels a byte, first pixel
+    // in the top bits, stored as its difference from the row above
+    vector<unsigned char> pixels((size_t) width + 3, 0);
+    size_t rowBytes = ((size_t) width + 3) / 4;
+    vector<unsigned char> row(rowBytes, 0);
+    vector<unsigned char> above(rowBytes, 0);
+    RunDeflater deflater;
+    for (int r = 0; r < board.numRows(); r++) {
+        drawRow(board, r, scale, pixels);
+        for (size_t i = 0; i < rowBytes; i++) {
+            const unsigned char* p = &pixels[i * 4];
+            row[i] = (unsigned char) (p[0] << 6 | p[1] << 4 | p[2] << 2 | p[3]);
+        }
+        for (int copy = 0; copy < scale; copy++) {
+            deflater.put(2);    // the Up filter
+            for (size_t i = 0; i < rowBytes; i++) {
+                deflater.put((unsigned char) (row[i] - above[i]));
+            }
+            above.swap(row);
+            row = above;
+            if (deflater.output.size() >= PNG_CHUNK_BYTES) {
+                writeChunk(output, "IDAT", deflater.output);
+                deflater.output.clear();
+            }
+        }
+    }
+    deflater.finish();
+    writeChunk(output, "IDAT", deflater.output);
+    writeChunk(output, "IEND", "");
+}
+
+void writePpmImage(ostream& output, const CellBoard& board, int scale) {
+    int width = 0;
+    int height = 0;
+    imageSize(board, scale, width, height);
+    output << "P6\n" << width << " " << height << "\n255\n";
+    vector<unsigned char> pixels((size_t) width, 0);
+    string row((size_t) width * 3, '\0');
+    for (int r = 0; r < board.numRows(); r++) {
+        drawRow(board, r, scale, pixels);
+        for (int x = 0; x < width; x++) {
+            const unsigned char* rgb = STATE_RGB[pixels[x]];
+            row[(size_t) x * 3] = (char) rgb[0];
+            row[(size_t) x * 3 + 1] = (char) rgb[1];
+            row[(size_t) x * 3 + 2] = (char) rgb[2];
+        }
+        for (int copy = 0; copy < scale; copy++) {
+            output << row;
+        }
+    }
+}
+
+FrameExporter::FrameExporter(const string& prefix, FrameFormat format, int scale, long long stride)
+        : prefix(prefix),
+          format(format),
+          scale(scale),
+          stride(stride > 0 ? stride : 1),
+          framesQueued(0),
+          framesWritten(0),
+          stopping(false) {
+    writer = thread(&FrameExporter::writerLoop, this);
+}
+
+FrameExporter::~FrameExporter() {
+    if (writer.joinable()) {
+        {
+            lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        frameQueued.notify_one();
+        writer.join();
+    }
+}
+
+bool FrameExporter::isDue(long long generation) const {
+    return generation % stride == 0;
+}
+
+void FrameExporter::submit(const CellBoard& board, long long generation) {
+    if (!isDue(generation)) {
+        return;
+    }
+    BoardFrame frame;
+    {
+        unique_lock<std::mutex> lock(mutex);
+        frameWritten.wait(lock, [this] {
+            return queue.size() < (size_t) MAX_QUEUED_FRAMES || !failure.empty();
+        });
+        checkFailure();
+        if (!spareBoards.empty()) {
+            frame.board.swap(spareBoards.back());
+            spareBoards.pop_back();
+        }
+    }
+    // copied outside the lock, into a board the writer is done with
+    frame.board = board;
+    frame.generation = generation;
+    {
+        lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(frame));
+        framesQueued++;
+    }
+    frameQueued.notify_one();
+}
+
+void FrameExporter::finish() {
+    if (writer.joinable()) {
+        {
+            lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        frameQueued.notify_one();
+        writer.join();
+    }
+    lock_guard<std::mutex> lock(mutex);
+    checkFailure();
+}
+
+int FrameExporter::getFramesWritten() const {
+    lock_guard<std::mutex> lock(mutex);
+    return framesWritten;
+}
+
+string FrameExporter::frameName(int frame) const {
+    string number = to_string(frame);
+    if ((int) number.length() < FRAME_NUMBER_DIGITS) {
+        number.insert(0, FRAME_NUMBER_DIGITS - number.length(), '0');
+    }
+    return prefix + number + (format == FRAME_PNG ? ".png" : ".ppm");
+}
+
+/*
+ * Throws an error if a frame could not be written.  Called with the mutex
+ * held.
+ */
+void FrameExporter::checkFailure() {
+    if (!failure.empty()) {
+        error(failure);
+    }
+}
+
+/*
+ * Body of the writer thread: write the queued frames in order until the
+ * exporter is stopped and the queue is empty, or a frame fails.
+ */
+void FrameExporter::writerLoop() {
+    while (true) {
+        BoardFrame frame;
+        int number = 0;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            frame = std::move(queue.front());
+            queue.pop_front();
+            number = framesWritten;
+        }
+        string filename = frameName(number);
+        string problem;
+        try {
+            ofstream output(filename.c_str(), ios::binary);
+            if (format == FRAME_PNG) {
+                writePngImage(output, frame.board, scale);
+            } else {
+                writePpmImage(output, frame.board, scale);
+            }
+            output.close();
+            if (!output) {
+                problem = "cannot write " + filename;
+            }
+        } catch (const ErrorException& ex) {
+            problem = ex.getMessage();
+        }
+        {
+            lock_guard<std::mutex> lock(mutex);
+            if (!problem.empty()) {
+                failure = problem;
+            } else {
+                framesWritten++;
+                spareBoards.push_back(std::move(frame.board));
+            }
+        }
+        frameWritten.notify_one();
+        if (!problem.empty()) {
+            return;
+        }
+    }
+}
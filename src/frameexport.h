@@ -0,0 +1,131 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the frame exporter, which draws boards into image
+ * files with no window, for making time-lapse videos of long runs.
+ * See frameexport.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _frameexport_h
+#define _frameexport_h
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cellboard.h"
+#include "triplebuffer.h"
+
+/**
+ * The image formats frames can be written in.
+ */
+enum FrameFormat {
+    FRAME_PNG,
+    FRAME_PPM
+};
+
+/**
+ * Draws a board as an image with each cell a square of scale x scale
+ * pixels, in the colors of the GUI: white for -, light gray for C, dark
+ * gray for O and black for X.
+ *
+ * The PNG image has a four-color palette, so a pixel takes two bits, and
+ * is compressed without zlib: each row is stored as its difference from
+ * the row above (PNG's Up filter), which turns repeated rows and empty
+ * areas into runs of zeros, and the runs are deflated as back-references
+ * to the byte before with the fixed Huffman codes.  Rows are encoded as
+ * they are drawn, so the image is never held whole.  The PPM image is
+ * the binary (P6) kind, three bytes a pixel with no compression.
+ * If the image would be more than 2^31 - 1 pixels wide or high, an error
+ * is thrown.
+ */
+void writePngImage(std::ostream& output, const CellBoard& board, int scale);
+void writePpmImage(std::ostream& output, const CellBoard& board, int scale);
+
+/**
+ * The FrameExporter class writes every Nth generation of a run to a
+ * numbered image file on a background thread, so the run only pays for
+ * copying each board it exports.
+ *
+ * Frames are numbered from 0 in the order they are exported, with six
+ * digits, so that video tools can read them as a sequence: a prefix of
+ * "out/life-" gives out/life-000000.png, out/life-000001.png, and so on.
+ * Boards wait in a queue of at most MAX_QUEUED_FRAMES; a run that gets
+ * ahead of the disk waits for room, so memory stays bounded.  The boards
+ * are reused once written, so a steady run allocates nothing.
+ */
+class FrameExporter {
+public:
+    /**
+     * The most boards waiting to be written at once.
+     */
+    static const int MAX_QUEUED_FRAMES = 4;
+
+    /**
+     * Starts an exporter that writes frames named by the given prefix in
+     * the given format, each cell scale x scale pixels, for the
+     * generations that are multiples of stride.
+     */
+    FrameExporter(const std::string& prefix, FrameFormat format, int scale, long long stride);
+
+    /**
+     * Finishes writing the frames if finish was not called.
+     */
+    ~FrameExporter();
+
+    /**
+     * Returns true if the given generation is one to export.
+     */
+    bool isDue(long long generation) const;
+
+    /**
+     * Queues a copy of board to be written as the next frame if
+     * generation is due, and does nothing otherwise.
+     * If an earlier frame could not be written, an error is thrown.
+     */
+    void submit(const CellBoard& board, long long generation);
+
+    /**
+     * Waits until every queued frame is written and stops the background
+     * thread.  If a frame could not be written, an error is thrown.
+     */
+    void finish();
+
+    /**
+     * Returns the number of frames written so far.
+     */
+    int getFramesWritten() const;
+
+    /**
+     * Returns the name of the file the given frame is written to.
+     */
+    std::string frameName(int frame) const;
+
+private:
+    void writerLoop();
+    void checkFailure();
+
+    std::string prefix;
+    FrameFormat format;
+    int scale;
+    long long stride;
+    std::thread writer;
+    mutable std::mutex mutex;
+    std::condition_variable frameQueued;    // the writer has a frame to write
+    std::condition_variable frameWritten;   // the queue has room again
+    std::deque<BoardFrame> queue;           // frames waiting to be written
+    std::vector<CellBoard> spareBoards;     // written boards to reuse
+    int framesQueued;
+    int framesWritten;
+    bool stopping;
+    std::string failure;                    // why a frame could not be written
+
+    FrameExporter(const FrameExporter&);            // not copyable
+    FrameExporter& operator =(const FrameExporter&);
+};
+
+#endif // _frameexport_h
@@ -0,0 +1,969 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the HashLife class.
+ * See hashlife.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "hashlife.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "error.h"
+
+using namespace std;
+
+const size_t HashLife::DEFAULT_MEMORY_LIMIT = (size_t) 1 << 30;
+
+// rough size of one entry of a result cache: key, value, link, and bucket
+static const size_t CACHE_ENTRY_BYTES = 48;
+
+/*
+ * Key of a remembered result: a node and the log2 of the generations.
+ */
+static uint64_t resultKey(int node, int generationsLog2) {
+    return (uint64_t) node << 8 | (uint64_t) generationsLog2;
+}
+
+/*
+ * Returns the next state of a cell under the decay rule, the same as
+ * singleCell: an empty cell with 2 or 3 occupied neighbors comes alive,
+ * every other cell ages one step.
+ */
+static int nextState(int state, int occupiedNeighbors) {
+    if (state != EMPTY) {
+        return state - 1;
+    }
+    return (occupiedNeighbors == 2 || occupiedNeighbors == 3) ? ALIVE : EMPTY;
+}
+
+/*
+ * Hash of the four children of a node.
+ */
+static size_t hashChildren(int nw, int ne, int sw, int se) {
+    uint64_t hash = (uint64_t) nw * 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (uint64_t) ne) * 0xC2B2AE3D27D4EB4FULL;
+    hash = (hash ^ (uint64_t) sw) * 0x165667B19E3779F9ULL;
+    hash = (hash ^ (uint64_t) se) * 0x9E3779B97F4A7C15ULL;
+    return (size_t) (hash ^ (hash >> 32));
+}
+
+HashLife::HashLife()
+        : freeList(-1),
+          liveNodes(0),
+          memoryLimit(DEFAULT_MEMORY_LIMIT),
+          maxStepLog2(0),
+          rows(0),
+          cols(0),
+          boardLevel(0),
+          startBoard(EMPTY),
+          currentBoard(EMPTY),
+          generation(0) {
+    stats = HashLifeStats();
+    for (int state = EMPTY; state <= ALIVE; state++) {
+        Node cell = {-1, -1, -1, -1, 0, -1, {0, 0, 0, 0}};
+        if (state != EMPTY) {
+            cell.population[state] = 1;
+        }
+        nodes.push_back(cell);
+        liveNodes++;
+    }
+    buckets.assign(1024, -1);
+    emptyNodes.push_back(EMPTY);
+}
+
+void HashLife::load(const CellBoard& board) {
+    int level = 1;
+    while ((1 << level) < max(board.numRows(), board.numCols())) {
+        level++;
+    }
+    startAt(build(board, level, 0, 0), board.numRows(), board.numCols());
+}
+
+void HashLife::advance(uint64_t generations) {
+    currentBoard = jumpBy(currentBoard, generations);
+    generation += generations;
+    compact();
+}
+
+uint64_t HashLife::advanceUntilEmpty(uint64_t generations) {
+    if (isEmpty(currentBoard)) {
+        return 0;
+    }
+    // an empty board stays empty, so the first empty generation is found by
+    // halving the jump, each probe starting from the latest board known not
+    // to be empty; an empty board is always the kept empty node
+    int alive = currentBoard;
+    uint64_t aliveAt = 0;
+    uint64_t emptyAt = generations;
+    pinned.push_back(alive);
+    int board = jumpBy(alive, generations);
+    if (isEmpty(board)) {
+        while (emptyAt - aliveAt > 1) {
+            uint64_t middle = aliveAt + (emptyAt - aliveAt) / 2;
+            int probe = jumpBy(alive, middle - aliveAt);
+            if (isEmpty(probe)) {
+                emptyAt = middle;
+                board = probe;
+            } else {
+                aliveAt = middle;
+                alive = probe;
+                pinned.back() = alive;
+            }
+        }
+    }
+    pinned.pop_back();
+    currentBoard = board;
+    generation += emptyAt;
+    compact();
+    return emptyAt;
+}
+
+uint64_t HashLife::getGeneration() const {
+    return generation;
+}
+
+uint64_t HashLife::population(CellState state) const {
+    return count(currentBoard, state);
+}
+
+uint64_t HashLife::populationAt(uint64_t generation, CellState state) {
+    uint64_t cells = count(jumpBy(startBoard, generation), state);
+    compact();
+    return cells;
+}
+
+void HashLife::toBoard(CellBoard& board) const {
+    board.resize(rows, cols);
+    write(currentBoard, 0, 0, 0, 0, board);
+}
+
+int HashLife::numRows() const {
+    return rows;
+}
+
+int HashLife::numCols() const {
+    return cols;
+}
+
+/*
+ * Macrocell files number the non-empty cell states from 1, starting with
+ * the state a cell is born in; here that is X, then O, then C.
+ */
+static const int MACROCELL_STATES[4] = {EMPTY, ALIVE, DYING, DECAYING};
+static const int MACROCELL_NUMBERS[4] = {0, 3, 2, 1};
+
+// the largest board side a Macrocell file can give, so that the node the
+// board sits in has a level below 31
+static const int MAX_SIZE = 1 << 30;
+
+uint64_t HashLife::readMacrocell(istream& input) {
+    string line;
+    if (!getline(input, line) || line.compare(0, 4, "[M2]") != 0) {
+        error("HashLife::readMacrocell input is not a Macrocell file");
+    }
+    uint64_t fileGeneration = 0;
+    int sizeRows = -1;
+    int sizeCols = -1;
+    vector<int> lineNodes(1, -1);    // the node on each line, numbered from 1
+    while (getline(input, line)) {
+        if (!line.empty() && line[line.length() - 1] == '\r') {
+            line.erase(line.length() - 1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            istringstream words(line);
+            string tag;
+            string name;
+            words >> tag;
+            if (tag == "#G") {
+                words >> fileGeneration;
+            } else if (tag == "#C" && words >> name && name == "size") {
+                words >> sizeRows >> sizeCols;
+            }
+        } else if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+            // an 8x8 two-state leaf, one row per $, with trailing empty
+            // cells and rows left out
+            int cells[8][8] = {{0}};
+            int row = 0;
+            int col = 0;
+            for (char ch : line) {
+                if (ch == '$') {
+                    row++;
+                    col = 0;
+                } else if (row < 8 && col < 8 && (ch == '.' || ch == '*')) {
+                    cells[row][col++] = ch == '*' ? ALIVE : EMPTY;
+                } else {
+                    error("HashLife::readMacrocell bad leaf line: " + line);
+                }
+            }
+            int level2[4][4];
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    level2[r][c] = join(cells[2 * r][2 * c], cells[2 * r][2 * c + 1],
+                                        cells[2 * r + 1][2 * c], cells[2 * r + 1][2 * c + 1]);
+                }
+            }
+            int quarter[2][2];
+            for (int r = 0; r < 2; r++) {
+                for (int c = 0; c < 2; c++) {
+                    quarter[r][c] = join(level2[2 * r][2 * c], level2[2 * r][2 * c + 1],
+                                         level2[2 * r + 1][2 * c], level2[2 * r + 1][2 * c + 1]);
+                }
+            }
+            lineNodes.push_back(join(quarter[0][0], quarter[0][1], quarter[1][0], quarter[1][1]));
+        } else {
+            istringstream words(line);
+            int level;
+            long long children[4];
+            if (!(words >> level >> children[0] >> children[1] >> children[2] >> children[3])
+                    || level < 1 || level > 30) {
+                error("HashLife::readMacrocell bad node line: " + line);
+            }
+            int ids[4];
+            for (int i = 0; i < 4; i++) {
+                if (level == 1) {
+                    if (children[i] < 0 || children[i] > 3) {
+                        error("HashLife::readMacrocell unknown cell state in line: " + line);
+                    }
+                    ids[i] = MACROCELL_STATES[children[i]];
+                } else if (children[i] == 0) {
+                    ids[i] = emptyNode(level - 1);
+                } else if (children[i] < (long long) lineNodes.size()
+                           && nodes[lineNodes[children[i]]].level == level - 1) {
+                    ids[i] = lineNodes[children[i]];
+                } else {
+                    error("HashLife::readMacrocell bad child in line: " + line);
+                }
+            }
+            lineNodes.push_back(join(ids[0], ids[1], ids[2], ids[3]));
+        }
+    }
+    if (lineNodes.size() < 2) {
+        error("HashLife::readMacrocell the file has no nodes");
+    }
+
+    int root = lineNodes.back();
+    int rootLevel = nodes[root].level;
+    if (sizeRows > MAX_SIZE || sizeCols > MAX_SIZE) {
+        error("HashLife::readMacrocell the board is too big");
+    }
+    if (sizeRows < 0 || sizeCols < 0) {
+        if (rootLevel > 30) {
+            error("HashLife::readMacrocell the pattern is too big for a board");
+        }
+        sizeRows = 1 << rootLevel;
+        sizeCols = 1 << rootLevel;
+    }
+    int level = 1;
+    while ((1 << level) < max(sizeRows, sizeCols)) {
+        level++;
+    }
+    // the board sits in the top-left of a node of that level
+    for (; rootLevel > level; rootLevel--) {
+        const Node n = nodes[root];
+        int empty = emptyNode(rootLevel - 1);
+        if (n.ne != empty || n.sw != empty || n.se != empty) {
+            error("HashLife::readMacrocell the pattern does not fit in the board");
+        }
+        root = n.nw;
+    }
+    for (; rootLevel < level; rootLevel++) {
+        int empty = emptyNode(rootLevel);
+        root = join(root, empty, empty, empty);
+    }
+    if (!isEmptyOutside(root, 0, 0, sizeRows, sizeCols)) {
+        error("HashLife::readMacrocell the pattern does not fit in the board");
+    }
+    startAt(root, sizeRows, sizeCols);
+    return fileGeneration;
+}
+
+void HashLife::writeMacrocell(ostream& output, uint64_t fileGeneration) const {
+    output << "[M2] (CS 106B/X Game of Life)\n";
+    output << "#R decay\n";
+    output << "#G " << fileGeneration << "\n";
+    output << "#C size " << rows << " " << cols << "\n";
+
+    // number the nodes children first, skipping empty ones, with an
+    // explicit stack so that deep trees cannot overflow the call stack
+    unordered_map<int, uint64_t> lineOf;
+    uint64_t lines = 0;
+    vector<pair<int, bool> > stack;
+    stack.push_back(make_pair(currentBoard, false));
+    while (!stack.empty()) {
+        int node = stack.back().first;
+        bool childrenDone = stack.back().second;
+        stack.pop_back();
+        const Node& n = nodes[node];
+        if (n.level == 0 || lineOf.count(node)
+                || n.population[DECAYING] + n.population[DYING] + n.population[ALIVE] == 0) {
+            continue;
+        }
+        if (n.level == 1) {
+            output << "1 " << MACROCELL_NUMBERS[n.nw] << " " << MACROCELL_NUMBERS[n.ne]
+                   << " " << MACROCELL_NUMBERS[n.sw] << " " << MACROCELL_NUMBERS[n.se] << "\n";
+            lineOf[node] = ++lines;
+        } else if (childrenDone) {
+            output << n.level;
+            for (int child : {n.nw, n.ne, n.sw, n.se}) {
+                unordered_map<int, uint64_t>::const_iterator found = lineOf.find(child);
+                output << " " << (found == lineOf.end() ? 0 : found->second);
+            }
+            output << "\n";
+            lineOf[node] = ++lines;
+        } else {
+            stack.push_back(make_pair(node, true));
+            stack.push_back(make_pair(n.se, false));
+            stack.push_back(make_pair(n.sw, false));
+            stack.push_back(make_pair(n.ne, false));
+            stack.push_back(make_pair(n.nw, false));
+        }
+    }
+    if (lines == 0) {
+        // an empty board still needs a root node
+        output << "1 0 0 0 0\n";
+    }
+}
+
+void HashLife::setMemoryLimit(size_t bytes) {
+    memoryLimit = bytes;
+}
+
+size_t HashLife::getMemoryLimit() const {
+    return memoryLimit;
+}
+
+void HashLife::collectGarbage(bool flush) {
+    vector<bool> marked(nodes.size(), false);
+    for (int state = EMPTY; state <= ALIVE; state++) {
+        marked[state] = true;
+    }
+    mark(startBoard, marked);
+    mark(currentBoard, marked);
+    for (int node : emptyNodes) {
+        mark(node, marked);
+    }
+    for (int board : pinned) {
+        mark(board, marked);
+    }
+
+    if (flush) {
+        // swapped out rather than cleared, which would keep their buckets
+        stats.evictions += results.size() + jumps.size();
+        unordered_map<uint64_t, int>().swap(results);
+        unordered_map<uint64_t, int>().swap(jumps);
+    } else {
+        // a surviving node keeps its results, which keep their own nodes
+        // alive, which may have results of their own
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            unordered_map<uint64_t, int>* caches[2] = {&results, &jumps};
+            for (unordered_map<uint64_t, int>* cache : caches) {
+                for (const pair<const uint64_t, int>& entry : *cache) {
+                    if (marked[entry.first >> 8] && !marked[entry.second]) {
+                        mark(entry.second, marked);
+                        changed = true;
+                    }
+                }
+            }
+        }
+        unordered_map<uint64_t, int>* caches[2] = {&results, &jumps};
+        for (unordered_map<uint64_t, int>* cache : caches) {
+            for (unordered_map<uint64_t, int>::iterator it = cache->begin(); it != cache->end(); ) {
+                if (marked[it->first >> 8]) {
+                    ++it;
+                } else {
+                    it = cache->erase(it);
+                    stats.evictions++;
+                }
+            }
+        }
+    }
+
+    // sweep the unmarked nodes onto the free list and rebuild the chains
+    for (int id = (int) nodes.size() - 1; id > ALIVE; id--) {
+        if (nodes[id].level >= 0 && !marked[id]) {
+            nodes[id].level = -1;
+            nodes[id].next = freeList;
+            freeList = id;
+            liveNodes--;
+            stats.freedNodes++;
+        }
+    }
+    rehash(buckets.size());
+    stats.collections++;
+    if (pinned.empty()) {
+        compact();
+    }
+}
+
+HashLifeStats HashLife::getStats() const {
+    HashLifeStats current = stats;
+    current.nodes = liveNodes;
+    current.bytes = memoryUsed();
+    return current;
+}
+
+/*
+ * Returns the number of cells of a board node in the given state.
+ */
+uint64_t HashLife::count(int board, CellState state) const {
+    const Node& n = nodes[board];
+    if (state == EMPTY) {
+        return (uint64_t) rows * cols - n.population[DECAYING]
+                - n.population[DYING] - n.population[ALIVE];
+    }
+    return n.population[state];
+}
+
+/*
+ * Returns true if every cell of a node is empty.
+ */
+bool HashLife::isEmpty(int node) const {
+    const Node& n = nodes[node];
+    return n.population[DECAYING] + n.population[DYING] + n.population[ALIVE] == 0;
+}
+
+/*
+ * Returns the estimated memory used by live nodes and cached results.
+ */
+size_t HashLife::memoryUsed() const {
+    return liveNodes * sizeof(Node) + buckets.size() * sizeof(int)
+            + (results.size() + jumps.size()) * CACHE_ENTRY_BYTES;
+}
+
+/*
+ * Rebuilds the hash chains of the live nodes with the given number of
+ * buckets, which must be a power of two.
+ */
+void HashLife::rehash(size_t bucketCount) {
+    buckets.assign(bucketCount, -1);
+    for (int id = ALIVE + 1; id < (int) nodes.size(); id++) {
+        Node& node = nodes[id];
+        if (node.level >= 0) {
+            size_t bucket = hashChildren(node.nw, node.ne, node.sw, node.se) & (bucketCount - 1);
+            node.next = buckets[bucket];
+            buckets[bucket] = id;
+        }
+    }
+}
+
+/*
+ * If at least half of the node store is free, moves the live nodes to the
+ * front of it, keeping their order, and gives the rest back, along with
+ * the spare buckets of the node and cache tables.  Freed nodes are reused
+ * before the store grows, but the store itself never shrinks otherwise.
+ * Node ids change, so this must not be called while a jump is in progress.
+ */
+void HashLife::compact() {
+    if (nodes.size() <= 2 * liveNodes) {
+        return;
+    }
+    // a node's new id is never larger than its old one, so the nodes can
+    // be moved down in place in order
+    vector<int> newId(nodes.size(), -1);
+    int live = 0;
+    for (int id = 0; id < (int) nodes.size(); id++) {
+        if (nodes[id].level >= 0) {
+            newId[id] = live++;
+        }
+    }
+    for (int id = 0; id < (int) nodes.size(); id++) {
+        if (newId[id] >= 0) {
+            Node node = nodes[id];
+            if (node.level > 0) {
+                node.nw = newId[node.nw];
+                node.ne = newId[node.ne];
+                node.sw = newId[node.sw];
+                node.se = newId[node.se];
+            }
+            nodes[newId[id]] = node;
+        }
+    }
+    nodes.resize(live);
+    nodes.shrink_to_fit();
+    freeList = -1;
+
+    startBoard = newId[startBoard];
+    currentBoard = newId[currentBoard];
+    for (int& node : emptyNodes) {
+        node = newId[node];
+    }
+    unordered_map<uint64_t, int>* caches[2] = {&results, &jumps};
+    for (unordered_map<uint64_t, int>* cache : caches) {
+        unordered_map<uint64_t, int> moved(cache->size());
+        for (const pair<const uint64_t, int>& entry : *cache) {
+            moved[resultKey(newId[entry.first >> 8], (int) (entry.first & 0xff))] = newId[entry.second];
+        }
+        cache->swap(moved);
+    }
+    size_t bucketCount = 1024;
+    while (bucketCount < liveNodes) {
+        bucketCount *= 2;
+    }
+    vector<int>().swap(buckets);
+    rehash(bucketCount);
+}
+
+/*
+ * Marks a node and everything below it as reachable.
+ */
+void HashLife::mark(int node, vector<bool>& marked) const {
+    vector<int> stack(1, node);
+    while (!stack.empty()) {
+        int id = stack.back();
+        stack.pop_back();
+        if (marked[id]) {
+            continue;
+        }
+        marked[id] = true;
+        const Node& n = nodes[id];
+        if (n.level > 0) {
+            stack.push_back(n.nw);
+            stack.push_back(n.ne);
+            stack.push_back(n.sw);
+            stack.push_back(n.se);
+        }
+    }
+}
+
+/*
+ * Makes board, a node of the right level for a board of the given size,
+ * the board at generation 0.  Jumps remembered for a board of another
+ * size do not apply to this one, so they are forgotten.
+ */
+void HashLife::startAt(int board, int boardRows, int boardCols) {
+    if (boardRows != rows || boardCols != cols) {
+        jumps.clear();
+    }
+    rows = boardRows;
+    cols = boardCols;
+    boardLevel = nodes[board].level;
+    startBoard = board;
+    currentBoard = board;
+    generation = 0;
+}
+
+/*
+ * Returns true if every cell of the node whose top-left cell is (row, col)
+ * that lies outside a board of the given size is empty.
+ */
+bool HashLife::isEmptyOutside(int node, int row, int col, int boardRows, int boardCols) const {
+    const Node& n = nodes[node];
+    if (n.population[DECAYING] + n.population[DYING] + n.population[ALIVE] == 0) {
+        return true;
+    }
+    if (row >= boardRows || col >= boardCols) {
+        return false;
+    }
+    if (n.level == 0 || (row + (1LL << n.level) <= boardRows && col + (1LL << n.level) <= boardCols)) {
+        return true;
+    }
+    int half = 1 << (n.level - 1);
+    return isEmptyOutside(n.nw, row, col, boardRows, boardCols)
+            && isEmptyOutside(n.ne, row, col + half, boardRows, boardCols)
+            && isEmptyOutside(n.sw, row + half, col, boardRows, boardCols)
+            && isEmptyOutside(n.se, row + half, col + half, boardRows, boardCols);
+}
+
+/*
+ * Returns the canonical node made of the four given children, which must
+ * all be of the same level.
+ */
+int HashLife::join(int nw, int ne, int sw, int se) {
+    size_t bucket = hashChildren(nw, ne, sw, se) & (buckets.size() - 1);
+    for (int id = buckets[bucket]; id >= 0; id = nodes[id].next) {
+        const Node& n = nodes[id];
+        if (n.nw == nw && n.ne == ne && n.sw == sw && n.se == se) {
+            return id;
+        }
+    }
+    Node node = {nw, ne, sw, se, nodes[nw].level + 1, buckets[bucket], {0, 0, 0, 0}};
+    for (int state = DECAYING; state <= ALIVE; state++) {
+        node.population[state] = nodes[nw].population[state] + nodes[ne].population[state]
+                + nodes[sw].population[state] + nodes[se].population[state];
+    }
+    int id;
+    if (freeList >= 0) {
+        id = freeList;
+        freeList = nodes[id].next;
+        nodes[id] = node;
+    } else {
+        id = (int) nodes.size();
+        nodes.push_back(node);
+    }
+    buckets[bucket] = id;
+    liveNodes++;
+    if (liveNodes > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+    return id;
+}
+
+/*
+ * Returns the node of the given level with every cell empty.
+ */
+int HashLife::emptyNode(int level) {
+    while ((int) emptyNodes.size() <= level) {
+        int child = emptyNodes.back();
+        emptyNodes.push_back(join(child, child, child, child));
+    }
+    return emptyNodes[level];
+}
+
+/*
+ * Returns the level k-1 node at the center of a level k node.
+ */
+int HashLife::centre(int node) {
+    const Node n = nodes[node];
+    return join(nodes[n.nw].se, nodes[n.ne].sw, nodes[n.sw].ne, nodes[n.se].nw);
+}
+
+/*
+ * Returns the level k-1 center of a level k node (k >= 2) advanced by
+ * 2^generationsLog2 generations, where generationsLog2 <= k - 2.
+ *
+ * The node is cut into nine overlapping level k-1 squares.  Advancing the
+ * center of each by half the generations (or taking their centers if the
+ * step is smaller than that) gives nine level k-2 squares, which are
+ * grouped into four level k-1 squares whose centers are advanced by the
+ * remaining generations and joined into the answer.
+ */
+int HashLife::step(int node, int generationsLog2) {
+    uint64_t key = resultKey(node, generationsLog2);
+    unordered_map<uint64_t, int>::const_iterator found = results.find(key);
+    if (found != results.end()) {
+        stats.hits++;
+        return found->second;
+    }
+    stats.misses++;
+
+    int result;
+    const Node n = nodes[node];
+    if (n.level == 2) {
+        result = stepBase(node);
+    } else {
+        const Node nw = nodes[n.nw];
+        const Node ne = nodes[n.ne];
+        const Node sw = nodes[n.sw];
+        const Node se = nodes[n.se];
+        int squares[9] = {
+            n.nw, join(nw.ne, ne.nw, nw.se, ne.sw), n.ne,
+            join(nw.sw, nw.se, sw.nw, sw.ne), join(nw.se, ne.sw, sw.ne, se.nw),
+            join(ne.sw, ne.se, se.nw, se.ne),
+            n.sw, join(sw.ne, se.nw, sw.se, se.sw), n.se
+        };
+        bool fullStep = generationsLog2 == n.level - 2;
+        int half[9];
+        for (int i = 0; i < 9; i++) {
+            half[i] = fullStep ? step(squares[i], n.level - 3) : centre(squares[i]);
+        }
+        int rest = fullStep ? n.level - 3 : generationsLog2;
+        result = join(step(join(half[0], half[1], half[3], half[4]), rest),
+                      step(join(half[1], half[2], half[4], half[5]), rest),
+                      step(join(half[3], half[4], half[6], half[7]), rest),
+                      step(join(half[4], half[5], half[7], half[8]), rest));
+    }
+    results[key] = result;
+    return result;
+}
+
+/*
+ * Advances the center 2x2 cells of a level 2 (4x4) node by one generation.
+ */
+int HashLife::stepBase(int node) {
+    int cells[4][4];
+    const Node& n = nodes[node];
+    int quadrants[4] = {n.nw, n.ne, n.sw, n.se};
+    for (int q = 0; q < 4; q++) {
+        const Node& quadrant = nodes[quadrants[q]];
+        int r = (q / 2) * 2;
+        int c = (q % 2) * 2;
+        cells[r][c] = quadrant.nw;
+        cells[r][c + 1] = quadrant.ne;
+        cells[r + 1][c] = quadrant.sw;
+        cells[r + 1][c + 1] = quadrant.se;
+    }
+    int next[4];
+    for (int i = 0; i < 4; i++) {
+        int r = 1 + i / 2;
+        int c = 1 + i % 2;
+        int occupied = 0;
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                if ((dr != 0 || dc != 0) && (cells[r + dr][c + dc] & 2)) {
+                    occupied++;
+                }
+            }
+        }
+        next[i] = nextState(cells[r][c], occupied);
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+/*
+ * Returns the node of the given level whose top-left cell is (row, col) of
+ * board; cells outside of the board are empty.
+ */
+int HashLife::build(const CellBoard& board, int level, int row, int col) {
+    if (row >= board.numRows() || col >= board.numCols()) {
+        return emptyNode(level);
+    }
+    if (level == 0) {
+        return board.get(row, col);
+    }
+    int half = 1 << (level - 1);
+    return join(build(board, level - 1, row, col),
+                build(board, level - 1, row, col + half),
+                build(board, level - 1, row + half, col),
+                build(board, level - 1, row + half, col + half));
+}
+
+/*
+ * Writes the cells of a node whose top-left cell is at (row, col) into
+ * board, shifted by (rowOffset, colOffset) and wrapped around its edges.
+ * Only the first rows x cols cells of the node are written; board must
+ * start out empty.
+ */
+void HashLife::write(int node, int row, int col, int rowOffset, int colOffset,
+                     CellBoard& board) const {
+    const Node& n = nodes[node];
+    if (row >= rows || col >= cols
+            || n.population[DECAYING] + n.population[DYING] + n.population[ALIVE] == 0) {
+        return;
+    }
+    if (n.level == 0) {
+        board.set((row + rowOffset) % rows, (col + colOffset) % cols, (CellState) node);
+        return;
+    }
+    int half = 1 << (n.level - 1);
+    write(n.nw, row, col, rowOffset, colOffset, board);
+    write(n.ne, row, col + half, rowOffset, colOffset, board);
+    write(n.sw, row + half, col, rowOffset, colOffset, board);
+    write(n.se, row + half, col + half, rowOffset, colOffset, board);
+}
+
+/*
+ * Returns the board node 2^generationsLog2 generations after the given one,
+ * made of two half-length jumps if it is too long for a single step.
+ */
+int HashLife::jump(int board, int generationsLog2) {
+    uint64_t key = resultKey(board, generationsLog2);
+    unordered_map<uint64_t, int>::const_iterator found = jumps.find(key);
+    if (found != jumps.end()) {
+        stats.hits++;
+        return found->second;
+    }
+    stats.misses++;
+    pinned.push_back(board);
+    int result;
+    if (generationsLog2 < boardLevel && (memoryLimit == 0 || generationsLog2 <= maxStepLog2)) {
+        result = jumpBase(board, generationsLog2);
+    } else {
+        result = jump(jump(board, generationsLog2 - 1), generationsLog2 - 1);
+    }
+    pinned.pop_back();
+    jumps[key] = result;
+    return result;
+}
+
+/*
+ * Advances a board node by 2^generationsLog2 generations in one HashLife
+ * step, where generationsLog2 < boardLevel.
+ *
+ * The window is the level boardLevel+1 square of the repeating plane
+ * starting at the board's top-left cell.  Its advanced center starts
+ * 2^(boardLevel-1) cells in and is at least as large as the board in both
+ * directions, so it holds every cell of the board, shifted by that much.
+ * Both the window and the board taken back out of the center are made by
+ * moving and overlaying nodes, never cell by cell, so a step costs about
+ * as much as the distinct nodes it touches, not the area of the board.
+ */
+int HashLife::jumpBase(int board, int generationsLog2) {
+    if (rows == 0 || cols == 0) {
+        return board;
+    }
+    if (memoryLimit > 0 && memoryUsed() > memoryLimit) {
+        collectGarbage(false);
+        if (memoryUsed() > memoryLimit / 2) {
+            collectGarbage(true);
+        }
+    }
+
+    // the board in the top-left of the window, then copies of everything
+    // so far below it and to its right until the window is full
+    unordered_map<uint64_t, int> overlays;
+    int64_t windowSize = (int64_t) 1 << (boardLevel + 1);
+    int empty = emptyNode(boardLevel);
+    int window = join(board, empty, empty, empty);
+    for (int64_t filled = rows; filled < windowSize; filled *= 2) {
+        window = overlay(window, translate(window, filled, 0), overlays);
+    }
+    for (int64_t filled = cols; filled < windowSize; filled *= 2) {
+        window = overlay(window, translate(window, 0, filled), overlays);
+    }
+    int centreNode = crop(step(window, generationsLog2), 0, 0);
+
+    // row r of the board is row (r - shift) mod rows of the center, so the
+    // center's first rows x cols cells are rotated back into place in up to
+    // four pieces
+    int64_t shift = (int64_t) 1 << (boardLevel - 1);
+    int64_t rowShift = shift % rows;
+    int64_t colShift = shift % cols;
+    int result = emptyNode(boardLevel);
+    for (int piece = 0; piece < 4; piece++) {
+        bool wrapsRows = piece / 2 == 1;
+        bool wrapsCols = piece % 2 == 1;
+        if ((wrapsRows && rowShift == 0) || (wrapsCols && colShift == 0)) {
+            continue;
+        }
+        int moved = translate(centreNode, wrapsRows ? rowShift - rows : rowShift,
+                              wrapsCols ? colShift - cols : colShift);
+        result = overlay(result, crop(moved, 0, 0), overlays);
+    }
+
+    // nothing made during a step can be collected until it is over, so a
+    // step that went over the limit is split in two from now on, and steps
+    // that leave plenty of room may double
+    if (memoryLimit > 0 && memoryUsed() > memoryLimit) {
+        maxStepLog2 = max(0, generationsLog2 - 1);
+    } else if (memoryLimit > 0 && memoryUsed() < memoryLimit / 4 && generationsLog2 == maxStepLog2) {
+        maxStepLog2++;
+    }
+    return result;
+}
+
+/*
+ * Returns a node with every cell outside of the board emptied, for a node
+ * whose top-left cell is (row, col) of the board.
+ */
+int HashLife::crop(int node, int64_t row, int64_t col) {
+    const Node n = nodes[node];
+    int64_t size = (int64_t) 1 << n.level;
+    if (isEmpty(node) || (row + size <= rows && col + size <= cols)) {
+        return node;
+    }
+    if (row >= rows || col >= cols) {
+        return emptyNode(n.level);
+    }
+    int64_t half = size / 2;
+    return join(crop(n.nw, row, col), crop(n.ne, row, col + half),
+                crop(n.sw, row + half, col), crop(n.se, row + half, col + half));
+}
+
+/*
+ * Returns the node holding the cells of both a and b, two nodes of the same
+ * level with no cell occupied in both.  Results are remembered in memo.
+ */
+int HashLife::overlay(int a, int b, unordered_map<uint64_t, int>& memo) {
+    if (isEmpty(b)) {
+        return a;
+    }
+    if (isEmpty(a) || nodes[a].level == 0) {
+        return b;
+    }
+    uint64_t key = (uint64_t) a << 32 | (uint32_t) b;
+    unordered_map<uint64_t, int>::const_iterator found = memo.find(key);
+    if (found != memo.end()) {
+        return found->second;
+    }
+    const Node na = nodes[a];
+    const Node nb = nodes[b];
+    int result = join(overlay(na.nw, nb.nw, memo), overlay(na.ne, nb.ne, memo),
+                      overlay(na.sw, nb.sw, memo), overlay(na.se, nb.se, memo));
+    memo[key] = result;
+    return result;
+}
+
+/*
+ * Returns a node moved down by rowShift and right by colShift cells; either
+ * may be negative, and neither may be larger than the node.  Cells moved
+ * past its edges are dropped and cells moved in are empty.
+ */
+int HashLife::translate(int node, int64_t rowShift, int64_t colShift) {
+    if (isEmpty(node) || (rowShift == 0 && colShift == 0)) {
+        return node;
+    }
+    // put the node in the quadrant of a larger one that the move comes
+    // from and take out the square it moves to
+    int level = nodes[node].level;
+    int64_t size = (int64_t) 1 << level;
+    int down = rowShift > 0 ? 1 : 0;
+    int right = colShift > 0 ? 1 : 0;
+    int empty = emptyNode(level);
+    int quadrants[4] = {empty, empty, empty, empty};
+    quadrants[down * 2 + right] = node;
+    unordered_map<int, int> memo;
+    return subsquare(join(quadrants[0], quadrants[1], quadrants[2], quadrants[3]),
+                     down * size - rowShift, right * size - colShift, memo);
+}
+
+/*
+ * Returns the level k-1 node whose top-left cell is (row, col) of a level k
+ * node, where 0 <= row, col <= 2^(k-1).
+ *
+ * The node's sixteen level k-2 grandchildren are grouped into the four
+ * level k-1 squares holding each quadrant of the answer, and each quadrant
+ * is taken out of its square the same way.  Below the first call the
+ * offset only depends on the level, so results are remembered by node in
+ * memo, which makes moving repeated areas cheap.
+ */
+int HashLife::subsquare(int node, int64_t row, int64_t col, unordered_map<int, int>& memo) {
+    const Node n = nodes[node];
+    int64_t size = (int64_t) 1 << (n.level - 1);
+    if (isEmpty(node)) {
+        return emptyNode(n.level - 1);
+    }
+    if (row % size == 0 && col % size == 0) {
+        int quadrants[4] = {n.nw, n.ne, n.sw, n.se};
+        return quadrants[row / size * 2 + col / size];
+    }
+    unordered_map<int, int>::const_iterator found = memo.find(node);
+    if (found != memo.end()) {
+        return found->second;
+    }
+
+    int grid[4][4];
+    int quadrants[4] = {n.nw, n.ne, n.sw, n.se};
+    for (int q = 0; q < 4; q++) {
+        const Node& quadrant = nodes[quadrants[q]];
+        int r = (q / 2) * 2;
+        int c = (q % 2) * 2;
+        grid[r][c] = quadrant.nw;
+        grid[r][c + 1] = quadrant.ne;
+        grid[r + 1][c] = quadrant.sw;
+        grid[r + 1][c + 1] = quadrant.se;
+    }
+    // an offset that is a multiple of the half never reads the next square
+    // down or right, which may lie past the grid
+    int64_t half = size / 2;
+    int parts[4];
+    for (int i = 0; i < 4; i++) {
+        int r = (int) (row / half) + i / 2;
+        int c = (int) (col / half) + i % 2;
+        int below = std::min(r + 1, 3);
+        int beside = std::min(c + 1, 3);
+        parts[i] = subsquare(join(grid[r][c], grid[r][beside], grid[below][c], grid[below][beside]),
+                             row % half, col % half, memo);
+    }
+    int result = join(parts[0], parts[1], parts[2], parts[3]);
+    memo[node] = result;
+    return result;
+}
+
+/*
+ * Returns the board node the given number of generations after board.
+ */
+int HashLife::jumpBy(int board, uint64_t generations) {
+    for (int bit = 0; bit < 64; bit++) {
+        if (generations >> bit & 1) {
+            board = jump(board, bit);
+        }
+    }
+    return board;
+}
@@ -0,0 +1,226 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the HashLife class, which jumps a board ahead by very
+ * large numbers of generations.
+ * See hashlife.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _hashlife_h
+#define _hashlife_h
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "cellboard.h"
+
+/**
+ * Counters describing the node cache of a HashLife engine.
+ */
+struct HashLifeStats {
+    std::uint64_t hits;         // results found in the cache
+    std::uint64_t misses;       // results that had to be computed
+    std::uint64_t evictions;    // cached results thrown away by garbage collection
+    std::uint64_t freedNodes;   // nodes reclaimed by garbage collection
+    int collections;            // garbage collections run
+    std::size_t nodes;          // nodes in use
+    std::size_t bytes;          // estimated memory used by nodes and results
+};
+
+/**
+ * The HashLife class runs the decay rule with Gosper's HashLife algorithm.
+ *
+ * A board is stored as a quadtree of macro-cells: a node of level k is a
+ * 2^k x 2^k square made of four level k-1 nodes, and a level 0 node is a
+ * single cell in one of the four states.  Every node is canonical (the
+ * same square is always the same node), so repeated areas are stored once,
+ * and the result of advancing a node's center is remembered, so it is
+ * only ever computed once however often the node appears.
+ *
+ * Plain HashLife works on an infinite plane, while the game is played on
+ * a torus.  A torus is the same as an infinite plane on which the board
+ * repeats in both directions, so one step advances a window of that
+ * plane twice the size of the board; its center, which covers the whole
+ * board, is correct after up to a quarter of the window size in
+ * generations.  Jumps of 2^j generations from a given board are
+ * remembered too, and longer jumps are made of two half-length ones, so
+ * once a colony repeats itself, a jump of 10^9 generations costs a few
+ * dozen lookups.
+ *
+ * Nodes and results are only ever added while the board is advanced, so
+ * the engine has a memory limit.  When it is exceeded between two steps,
+ * nodes that can no longer be reached from the board are collected (mark
+ * and sweep), keeping the cached results of the nodes that survive; if
+ * that does not free at least half of the limit, every cached result is
+ * thrown away as well and only the board itself is kept.  Freed nodes are
+ * reused by the steps that follow, and once the jump is over, a store
+ * left at least half free is compacted so that its memory is given back.
+ * Collections only happen between steps, so with a limit, steps start at
+ * a single generation and double in length while they leave the store
+ * well under it, and are halved after one that takes it over.
+ */
+class HashLife {
+public:
+    /**
+     * Creates an engine holding an empty 0x0 board.
+     */
+    HashLife();
+
+    /**
+     * Replaces the board with a copy of the given one, at generation 0.
+     */
+    void load(const CellBoard& board);
+
+    /**
+     * Advances the board by the given number of generations.
+     */
+    void advance(std::uint64_t generations);
+
+    /**
+     * Advances the board by up to the given number of generations, but
+     * stops at the first one at which every cell is empty, and returns the
+     * number of generations it was advanced by (0 if it was empty).
+     */
+    std::uint64_t advanceUntilEmpty(std::uint64_t generations);
+
+    /**
+     * Returns the number of generations the board has been advanced by
+     * since it was loaded.
+     */
+    std::uint64_t getGeneration() const;
+
+    /**
+     * Returns the number of cells of the board in the given state.
+     */
+    std::uint64_t population(CellState state = ALIVE) const;
+
+    /**
+     * Returns the number of cells in the given state at the given
+     * generation counted from the loaded board, without changing the
+     * current board.
+     */
+    std::uint64_t populationAt(std::uint64_t generation, CellState state = ALIVE);
+
+    /**
+     * Copies the current board into board, resizing it to match.
+     */
+    void toBoard(CellBoard& board) const;
+
+    /**
+     * Returns the number of rows/columns in the board.
+     */
+    int numRows() const;
+    int numCols() const;
+
+    /**
+     * Replaces the board with one read from a Golly Macrocell (.mc) file,
+     * at generation 0, and returns the generation given by its #G line
+     * (0 if it has none).
+     *
+     * Each line of a Macrocell file is one node of the quadtree, made of
+     * nodes on earlier lines, so the file is read in one pass straight
+     * into the node store and the board is never held cell by cell.
+     * Advancing it works on nodes too, so a sparse pattern on a board far
+     * bigger than memory costs about as much as the pattern's own nodes.
+     * Leaves can be the 8x8 two-state blocks of ".*$" text, where * is an
+     * X, or level 1 nodes of four cell states, where 1 is X, 2 is O and
+     * 3 is C.  The board is the size given by a "#C size ROWS COLS" line,
+     * or the square the root node covers if there is none.
+     * If the file is not valid, or has cells outside the board, an error
+     * is thrown.
+     */
+    std::uint64_t readMacrocell(std::istream& input);
+
+    /**
+     * Writes the current board as a Macrocell file with level 1 leaves,
+     * giving the generation on a #G line and the board size on a
+     * "#C size" line.  Every distinct node is written once, so the file
+     * grows with the number of distinct nodes, not the area of the board.
+     */
+    void writeMacrocell(std::ostream& output, std::uint64_t fileGeneration) const;
+
+    /**
+     * Sets/returns the memory limit in bytes for nodes and cached results.
+     * 0 means no limit.  The limit is checked between steps, and a single
+     * step can go over it by the nodes and results it creates; steps are
+     * shortened while they do.
+     */
+    void setMemoryLimit(std::size_t bytes);
+    std::size_t getMemoryLimit() const;
+
+    /**
+     * Frees every node that cannot be reached from the board, and with
+     * flush set, every cached result too.  A node store left at least
+     * half free is compacted, giving its memory back.
+     */
+    void collectGarbage(bool flush = false);
+
+    /**
+     * Returns the cache counters.
+     */
+    HashLifeStats getStats() const;
+
+    /**
+     * The memory limit of a newly created engine (1 GB).
+     */
+    static const std::size_t DEFAULT_MEMORY_LIMIT;
+
+private:
+    /*
+     * A square of cells.  Node ids 0-3 are the single cells, numbered by
+     * their CellState; other nodes are made of four children.
+     */
+    struct Node {
+        int nw, ne, sw, se;                 // children, or -1 for a cell
+        int level;                          // the node is 2^level cells wide, -1 if free
+        int next;                           // next node in its hash bucket or the free list
+        std::uint64_t population[4];        // cells in each state but EMPTY
+    };
+
+    std::uint64_t count(int board, CellState state) const;
+    bool isEmpty(int node) const;
+    std::size_t memoryUsed() const;
+    void rehash(std::size_t bucketCount);
+    void compact();
+    void mark(int node, std::vector<bool>& marked) const;
+    int join(int nw, int ne, int sw, int se);
+    int emptyNode(int level);
+    int centre(int node);
+    int step(int node, int generationsLog2);
+    int stepBase(int node);
+    void startAt(int board, int boardRows, int boardCols);
+    bool isEmptyOutside(int node, int row, int col, int boardRows, int boardCols) const;
+    int build(const CellBoard& board, int level, int row, int col);
+    void write(int node, int row, int col, int rowOffset, int colOffset,
+               CellBoard& board) const;
+    int jump(int board, int generationsLog2);
+    int jumpBase(int board, int generationsLog2);
+    int crop(int node, std::int64_t row, std::int64_t col);
+    int overlay(int a, int b, std::unordered_map<std::uint64_t, int>& memo);
+    int translate(int node, std::int64_t rowShift, std::int64_t colShift);
+    int subsquare(int node, std::int64_t row, std::int64_t col, std::unordered_map<int, int>& memo);
+    int jumpBy(int board, std::uint64_t generations);
+
+    std::vector<Node> nodes;
+    std::vector<int> buckets;                           // heads of the node hash chains
+    int freeList;
+    std::size_t liveNodes;
+    std::unordered_map<std::uint64_t, int> results;     // (node, log2 of steps) -> center
+    std::unordered_map<std::uint64_t, int> jumps;       // (board, log2 of steps) -> board
+    std::vector<int> emptyNodes;
+    std::vector<int> pinned;    // boards that jumps in progress still need
+    std::size_t memoryLimit;
+    int maxStepLog2;        // with a limit, steps go at most 2^this generations
+    HashLifeStats stats;
+    int rows;
+    int cols;
+    int boardLevel;         // the board sits in the top-left of a node of this level
+    int startBoard;
+    int currentBoard;
+    std::uint64_t generation;
+};
+
+#endif // _hashlife_h
@@ -3,6 +3,13 @@
  *  - Add random world generator
  *  - Make tick function detect stable world to stop extra calculations and animations
  *  - Add statistics option for finding patterns in the simulation
+ *  - Add benchmark option comparing the speed of the generation kernels
+ *  - Add jump option that skips far ahead with HashLife
+ *  - Add unbounded plane option with a movable viewport
+ *  - Add headless batch mode driven by command-line options
+ *  - Add script files and counted commands like "t 10000", run from a command queue
+ *  - Add paced animation at a chosen frame rate, many generations a frame
+ *  - Add zoom option that zooms and moves the GUI's view of the grid
  * Authors: Bruce Yang and Kevin Li
  * Description: The Game of Life is a simulation by British mathematician J. H. Conway in 1970. The game models
  * the life cycle of bacteria using a two-dimensional grid of cells. Given an initial pattern, the game
@@ -14,58 +21,127 @@
 #include <iostream>
 #include "console.h"
 #include "lifegui.h"
-#include "grid.h"
+#include "cellboard.h"
+#include "lifekernel.h"
+#include "lifeengine.h"
+#include "benchmark.h"
+#include "hashlife.h"
+#include "sparseboard.h"
+#include "zobrist.h"
+#include "boardfile.h"
+#include "batch.h"
+#include "consolerenderer.h"
+#include "triplebuffer.h"
 #include "strlib.h"
+#include "timer.h"
 #include <fstream>
 #include "filelib.h"
 #include "simpio.h"
 #include "random.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 
 const int MAX_ROW_LENGTH = 50;
 const int MAX_COLUMN_LENGTH = 50;
-const int MAX_STATS_TRIALS = 300;
+const int MAX_STATS_TRIALS = 2000000;
+const int ANIMATION_FRAME_MS = 100;
+const long long MAX_GENERATIONS_PER_FRAME = 1LL << 40;
+const long long HASHLIFE_MIN_GENERATIONS = 64;
+
+/*
+ * The unbounded plane mode.  While it is on, the colony lives on plane and
+ * grid is only the window onto it whose top-left cell is (top, left).
+ */
+struct UnboundedView {
+    bool isOn;
+    SparseBoard plane;
+    long long top;
+    long long left;
+};
 
 void introduce();
 void runGame();
-bool promptForInput(ifstream& file);
-void initializeGame(Grid<string>& grid);
-int findDuplicatedGrid(Grid<string> grid, Vector<Grid<string>> grids);
-int numberOfLiveCells(Grid<string> grid);
-void statistics(const Grid<string>& grid);
-bool tick(Grid<string>& grid, bool isPrintingGrid = true);
-void promptAction(Grid<string>& grid);
-void loadAnotherFile();
-void animate(int frames, Grid<string>& grid);
-void singleCell(const Grid<string>& copy, Grid<string>& grid, int r, int c);
-bool isCellOccupied(int r, int c, const Grid<string>& copy);
-int getNumOfNeighbors(int r, int c, const Grid<string>& copy);
-void degradeCell(int r, int c, Grid<string>& copy);
-void generateCell(int r, int c, Grid<string>& grid);
-void copyGrid(const Grid<string>& original, Grid<string>& copy);
-void printGrid(const Grid<string>& grid);
-void showGUI(const Grid<string>& grid);
-void updateGUI(const Grid<string>& grid);
+bool promptForInput(string& filename);
+void initializeGame(CellBoard& grid);
+int64_t numberOfLiveCells(const CellBoard& grid);
+void statistics(const CellBoard& grid);
+long long findPeriod(CellBoard& grid, uint64_t& hash, long long maxFrames);
+long long findPatternStart(const CellBoard& grid, long long period, CellBoard& frame);
+void advanceGrid(CellBoard& grid, long long generations);
+void stepGrid(CellBoard& grid, CellBoard& next, uint64_t& hash);
+bool tick(CellBoard& grid, CellBoard& next, bool isPrintingGrid = true, UnboundedView* view = nullptr);
+void promptAction(CellBoard& grid, UnboundedView& view);
+bool parseCommand(const string& command, string& actionName, int& count);
+void readScript(const string& filename, deque<string>& commands);
+bool loadAnotherFile();
+long long animate(int frames, CellBoard& grid, UnboundedView& view,
+                  int frameMs = ANIMATION_FRAME_MS, long long generationsPerFrame = 1);
+long long advanceFrame(CellBoard& grid, CellBoard& next, UnboundedView& view, HashLife* hashLife,
+                       long long generations);
+void renderFrames(TripleBuffer& frames, const atomic<bool>& finished, int frameMs);
+void pacedAnimation(int frames, CellBoard& grid, UnboundedView& view);
+void jump(int generations, CellBoard& grid, UnboundedView& view);
+void toggleUnbounded(CellBoard& grid, UnboundedView& view);
+void moveViewport(CellBoard& grid, UnboundedView& view);
+void zoomGUI(const CellBoard& grid);
+void copyGrid(const CellBoard& original, CellBoard& copy);
+void printGrid(const CellBoard& grid);
+void showGUI(const CellBoard& grid);
+void updateGUI(const CellBoard& grid);
 
 int main() {
     introduce();
     LifeGUI::initialize();
-    runGame();
+    do {
+        runGame();
+    } while (loadAnotherFile());
     cout<<"Have a nice Life!"<<endl;
     return 0;
 }
 
+#ifdef SPL_HEADLESS_MODE
+/*
+ * The entry point of the headless build (see the headless option in
+ * Life.pro), which stands in for the Stanford library's own so that it
+ * can see the command line.  With options it runs a batch job straight
+ * away, without starting the library; without them it starts the library
+ * as usual, which then runs the game above in the plain console.
+ */
+int qMain(int argc, char** argv);
+
+#undef main
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return runBatch(argc, argv);
+    }
+    return qMain(argc, argv);
+}
+#define main qMain
+#endif // SPL_HEADLESS_MODE
+
 /*
  * Start running the simulation.
- * This function is called every time a new file is loaded
+ * This function is called every time a new file is loaded, and returns
+ * when the user quits it
  * @precondition LifeGUI::initialize() is run to make sure that GUI is started
  */
 void runGame() {
-    Grid<string> grid(0,0);
+    CellBoard grid(0,0);
+    UnboundedView view;
+    view.isOn = false;
+    view.top = 0;
+    view.left = 0;
     initializeGame(grid);
     printGrid(grid);
     showGUI(grid);
-    promptAction(grid);
+    promptAction(grid, view);
 }
 
 /*
@@ -82,36 +158,16 @@ void introduce(){
 }
 
 /*
- * Initialize the grid using the input text file.
+ * Initialize the grid using the input file, in any format readBoardFile reads.
  * @param grid the simulation grid
  */
-void initializeGame(Grid<string>& grid){
+void initializeGame(CellBoard& grid){
     int row;
     int col;
-    ifstream file;
-    if (promptForInput(file)) { // a filename is inputed
-        string line;
-        int count = 0;
-        while(getline(file, line)) {
-            if (count == 0) {
-                row= stringToInteger(line);
-            } else if(count == 1) {
-                col= stringToInteger(line);
-            } else {
-                if (grid.size() == 0){
-                    grid.resize(row, col);
-                }
-                int gridRow = count - 2;
-                for(int gridCol = 0; gridCol < line.length(); gridCol++){
-                    grid.set(gridRow, gridCol, line.substr(gridCol, 1));
-                }
-                if (count >= row + 1) {
-                    break;
-                }
-            }
-            count++;
-        }
-        file.close();
+    string filename;
+    if (promptForInput(filename)) { // a filename is inputed
+        uint64_t generation;
+        readBoardFile(filename, grid, generation);
     } else { // generate a random world
         // randomly generate grid's row and column length
         row = randomInteger(3, MAX_ROW_LENGTH);
@@ -124,9 +180,9 @@ void initializeGame(Grid<string>& grid){
             for (int c = 0; c < col; c++) {
                 bool createNewCell = randomBool();
                 if (createNewCell) {
-                    grid[r][c] = "X";
+                    grid.set(r, c, ALIVE);
                 } else {
-                    grid[r][c] = "-";
+                    grid.set(r, c, EMPTY);
                 }
             }
         }
@@ -135,44 +191,36 @@ void initializeGame(Grid<string>& grid){
 
 /*
  * Prompt the user for input file name and the user can type "random" to generate a random grid.
- * @param file the input file variable to assign to if user input is not "random"
+ * @param filename set to the name of the file the user inputted
  * @return true if the user inputted a valid file name, false if user inputted "random"
  */
-bool promptForInput(ifstream& file) {
-    string filename = "";
+bool promptForInput(string& filename) {
+    filename = "";
     while (!fileExists(filename) && filename != "random") {
         filename = getLine("Grid input file name? (or random)");
     }
-    if (filename == "random") {
-        return false;
-    } else {
-        openFile(file, filename);
-        return true;
-    }
+    return filename != "random";
 }
 
 /*
  * Show the GUI of the simulation.
  * @param grid the simulation grid
  */
-void showGUI(const Grid<string>& grid) {
-    LifeGUI::resize(grid.numRows(), grid.numCols());
+void showGUI(const CellBoard& grid) {
     updateGUI(grid);
     LifeGUI::repaint();
 }
 
 /*
  * Update the GUI of the simulation (create/kill cells).
+ * The GUI redraws only the cells in its view that differ from the grid it
+ * last showed, and shades a zoomed-out view from a density map, so a
+ * generation costs in proportion to the cells that changed or the pixels
+ * shown; the whole grid is drawn when the GUI has been laid out afresh.
  * @param grid the simulation grid
  */
-void updateGUI(const Grid<string>& grid) {
-    for (int r = 0; r < grid.numRows(); r++) {
-        for (int c = 0; c < grid.numCols(); c++) {
-            if (isCellOccupied(r, c, grid)) {
-                LifeGUI::fillCell(r, c);
-            }
-        }
-    }
+void updateGUI(const CellBoard& grid) {
+    LifeGUI::drawBoard(grid);
 }
 
 /*
@@ -180,40 +228,139 @@ void updateGUI(const Grid<string>& grid) {
  *
  * Type "t" or press ENTER for running a tick
  * Type "a" for running multiple ticks in an animation
+ * Type "p" for an animation at a chosen frame rate, many generations a frame
+ * Type "s" for finding patterns in the simulation
+ * Type "j" for skipping many generations ahead at once
+ * Type "u" for switching between wrapping edges and an unbounded plane
+ * Type "v" for moving the window onto the unbounded plane
+ * Type "z" for zooming and moving the GUI's view of the grid
+ * Type "b" for measuring the speed of the generation kernels
+ * Type "r" for running the commands in a script file
  * Type "q" to quit the program or load a new input file
  *
+ * "t", "a", "p" and "j" can be followed by a count: "t 10000" runs 10000
+ * ticks and prints only the last grid, "a 500" and "p 500" animate 500
+ * frames, and "j 100" jumps 100 generations, without asking how many.
+ *
+ * Commands wait in a queue, which a script fills with its lines and the
+ * user fills one at a time when it is empty, and are run one after another
+ * in a loop, so a session can run any number of commands.
+ *
  * @param grid the simulation grid
+ * @param view the unbounded plane mode
  */
-void promptAction(Grid<string>& grid) {
-    string actionName = toLowerCase(getLine("a)nimate, t)ick, s)tatistics, q)uit? "));
-    if (actionName == "t" || actionName == "") {
-        bool keepRunning = tick(grid);
-        if (!keepRunning) { // the grid is stable
-            cout << "No grid is displayed because this world is stable." << endl;
+void promptAction(CellBoard& grid, UnboundedView& view) {
+    deque<string> commands;
+    CellBoard next(0, 0); // the back buffer of the ticks, kept between them
+    while (true) {
+        string command;
+        if (commands.empty()) {
+            command = getLine("a)nimate, p)aced, t)ick, s)tatistics, j)ump, u)nbounded, v)iewport, z)oom, b)enchmark, r)un script, q)uit? ");
+        } else {
+            command = commands.front();
+            commands.pop_front();
+        }
+        string actionName;
+        int count = 0;
+        if (!parseCommand(command, actionName, count)) {
+            cout << "Invalid choice; please try again." << endl;
+        } else if (actionName == "t" || actionName == "") {
+            int ticks = count > 0 ? count : 1;
+            bool keepRunning = true;
+            for (int i = 0; i < ticks && keepRunning; i++) {
+                keepRunning = tick(grid, next, i == ticks - 1, &view);
+            }
+            if (!keepRunning) { // the grid is stable
+                cout << "No grid is displayed because this world is stable." << endl;
+            }
+        } else if (actionName == "a") {
+            int frames = count > 0 ? count : getInteger("How many frames? ");
+            if (frames > 0) {
+                animate(frames, grid, view);
+            }
+        } else if (actionName == "p") {
+            int frames = count > 0 ? count : getInteger("How many frames? ");
+            if (frames > 0) {
+                pacedAnimation(frames, grid, view);
+            }
+        } else if (actionName == "s") {
+            statistics(grid);
+        } else if (actionName == "j") {
+            int generations = count > 0 ? count : getInteger("How many generations? ");
+            if (generations > 0) {
+                jump(generations, grid, view);
+            }
+        } else if (actionName == "u") {
+            toggleUnbounded(grid, view);
+        } else if (actionName == "v") {
+            moveViewport(grid, view);
+        } else if (actionName == "z") {
+            zoomGUI(grid);
+        } else if (actionName == "b") {
+            benchmarkKernels(grid);
+        } else if (actionName == "r") {
+            readScript(getLine("Script file name? "), commands);
+        } else if (actionName == "q") {
+            return;
+        } else {
+            cout << "Invalid choice; please try again." << endl;
         }
-    } else if (actionName == "a") {
-        int frames = getInteger("How many frames? ");
-        if (frames > 0) {
-            animate(frames, grid);
+    }
+}
+
+/*
+ * Split a command into its action and its count, if it has one.
+ * @param  command    the command as typed, e.g. "t 10000"
+ * @param  actionName set to the action in lower case, or "" for a blank command
+ * @param  count      set to the count, or 0 if there is none
+ * @return false if the count is not a positive number or there is anything after it
+ */
+bool parseCommand(const string& command, string& actionName, int& count) {
+    istringstream words(command);
+    string countText;
+    string extra;
+    words >> actionName >> countText >> extra;
+    actionName = toLowerCase(actionName);
+    count = 0;
+    if (countText != "") {
+        if (!stringIsInteger(countText) || (count = stringToInteger(countText)) <= 0) {
+            return false;
         }
-    } else if (actionName == "s") {
-        statistics(grid);
-    } else if (actionName == "q") {
-        loadAnotherFile();
+    }
+    return extra == "";
+}
+
+/*
+ * Put the commands in a script file at the front of the queue, one per
+ * line, so that they run next and in order.  Blank lines and lines
+ * starting with # are skipped.
+ * @param filename the script file
+ * @param commands the queue of commands waiting to run
+ */
+void readScript(const string& filename, deque<string>& commands) {
+    ifstream file;
+    if (!fileExists(filename)) {
+        cout << "Cannot find the script " << filename << "." << endl;
         return;
-    } else {
-        cout << "Invalid choice; please try again." << endl;
     }
-    promptAction(grid);
+    openFile(file, filename);
+    vector<string> script;
+    string line;
+    while (getline(file, line)) {
+        string::size_type start = line.find_first_not_of(" \t\r");
+        if (start != string::npos && line[start] != '#') {
+            script.push_back(line);
+        }
+    }
+    commands.insert(commands.begin(), script.begin(), script.end());
 }
 
 /*
  * Prompt the user to load a new file or end the simulation.
+ * @return true if the user wants to load another file
  */
-void loadAnotherFile() {
-    if (getYesOrNo("Load another file? (y/n) ")) {
-        runGame();
-    }
+bool loadAnotherFile() {
+    return getYesOrNo("Load another file? (y/n) ");
 }
 
 /*
@@ -222,24 +369,66 @@ void loadAnotherFile() {
  * Stable, dead, or repeating grids can all be detected.
  * If found, users have option to either print or animate the repeated pattern.
  *
+ * The first MAX_STATS_TRIALS frames are searched with a hash of every frame.
+ * If no pattern turns up there, users can keep looking for as many frames
+ * as they like with Brent's algorithm, which keeps only two grids.
+ *
  * @param grid the simulation grid
  */
-void statistics(const Grid<string>& grid) {
-    Grid<string> copy;
+void statistics(const CellBoard& grid) {
+    // frame i is the grid after i + 1 generations; frames are remembered
+    // only by their hash, and a frame is rebuilt to compare with in full
+    // only when its hash comes up again.  Every frame is kept, even one
+    // whose hash some other frame has too, so a collision cannot hide a
+    // repeat; the frames sharing a hash are rebuilt in one replay, in order.
+    unordered_multimap<uint64_t, int> frames;
+    CellBoard copy;
     copyGrid(grid, copy);
-    Vector<Grid<string>> grids;
-    int lastGenerationIndex = MAX_STATS_TRIALS - 1;
-    int duplicatedIndex = -1;
+    CellBoard next(copy.numRows(), copy.numCols());
+    uint64_t hash = zobristHash(copy);
+    long long lastGenerationIndex = MAX_STATS_TRIALS - 1;
+    long long duplicatedIndex = -1;
+    vector<int> sameHash;
     for (int i = 0; i < MAX_STATS_TRIALS; i++) {
-        tick(copy, false);
-        duplicatedIndex = findDuplicatedGrid(copy, grids);
+        stepGrid(copy, next, hash);
+        sameHash.clear();
+        typedef unordered_multimap<uint64_t, int>::const_iterator FrameIterator;
+        pair<FrameIterator, FrameIterator> found = frames.equal_range(hash);
+        for (FrameIterator it = found.first; it != found.second; ++it) {
+            sameHash.push_back(it->second);
+        }
+        sort(sameHash.begin(), sameHash.end());
+        CellBoard frame;
+        long long frameIndex = -1;
+        for (int index : sameHash) {
+            if (frameIndex < 0) {
+                copyGrid(grid, frame);
+            }
+            advanceGrid(frame, index - frameIndex);
+            frameIndex = index;
+            if (frame == copy) {
+                duplicatedIndex = index;
+                lastGenerationIndex = i - 1;
+                break;
+            }
+        }
         if (duplicatedIndex >= 0) {
-            lastGenerationIndex = i - 1;
             break;
-        } else {
-            Grid<string> copyOfCopy;
-            copyGrid(copy, copyOfCopy);
-            grids.add(copyOfCopy);
+        }
+        frames.insert(make_pair(hash, i));
+    }
+    if (duplicatedIndex < 0) {
+        unordered_multimap<uint64_t, int>().swap(frames);
+        int moreFrames = getInteger("No pattern in the first " + integerToString(MAX_STATS_TRIALS)
+                                    + " frames. How many more frames to search? (0 to stop) ");
+        if (moreFrames > 0) {
+            long long period = findPeriod(copy, hash, moreFrames);
+            if (period > 0) {
+                duplicatedIndex = findPatternStart(grid, period, copy);
+                lastGenerationIndex = duplicatedIndex + period - 1;
+            } else {
+                lastGenerationIndex += moreFrames;
+            }
         }
     }
     if (duplicatedIndex >= 0) {
@@ -254,17 +443,30 @@ void statistics(const Grid<string>& grid) {
                     lastGenerationIndex << "." << endl;
         }
         string actionName = toLowerCase(getLine("p)rint or a)nimate the pattern frames? (type no to skip) "));
+        CellBoard frame;
+        copyGrid(grid, frame);
+        advanceGrid(frame, duplicatedIndex + 1);
         if (startsWith(actionName, "p")) {
-            for (int j = duplicatedIndex; j < lastGenerationIndex + 1; j++) {
-                printGrid(grids[j]);
+            for (long long j = duplicatedIndex; j < lastGenerationIndex + 1; j++) {
+                printGrid(frame);
                 cout << endl;
+                advanceGrid(frame, 1);
             }
         } else if (startsWith(actionName, "a")) {
-            for (int j = duplicatedIndex; j < lastGenerationIndex + 1; j++) {
-                printGrid(grids[j]);
-                pause(100);
-                clearConsole();
+            bool redrawChanges = ConsoleRenderer::isSupported();
+            ConsoleRenderer renderer;
+            for (long long j = duplicatedIndex; j < lastGenerationIndex + 1; j++) {
+                if (redrawChanges) {
+                    renderer.render(frame);
+                    pause(100);
+                } else {
+                    printGrid(frame);
+                    pause(100);
+                    clearConsole();
+                }
+                advanceGrid(frame, 1);
             }
+            renderer.finish();
         } else if (startsWith(actionName, "n")) {
 
         }
@@ -276,177 +478,399 @@ void statistics(const Grid<string>& grid) {
     }
 }
 
+/*
+ * Find the period of the cycle a simulation falls into with Brent's
+ * algorithm: the tortoise waits at a frame while the hare runs up to a
+ * power of two frames ahead of it, then jumps to the hare, so only two
+ * grids are kept however long the search runs.  Frames are compared by
+ * hash first and in full only when the hashes match.
+ * @param  grid      the frame to start from, left at the last frame searched
+ * @param  hash      the hash of grid, kept up to date with it
+ * @param  maxFrames the number of frames to search
+ * @return the number of frames in the cycle, or 0 if none was found
+ */
+long long findPeriod(CellBoard& grid, uint64_t& hash, long long maxFrames) {
+    CellBoard tortoise;
+    copyGrid(grid, tortoise);
+    uint64_t tortoiseHash = hash;
+    CellBoard next(grid.numRows(), grid.numCols());
+    long long power = 1;
+    long long period = 0;
+    for (long long i = 0; i < maxFrames; i++) {
+        stepGrid(grid, next, hash);
+        period++;
+        if (hash == tortoiseHash && grid == tortoise) {
+            return period;
+        }
+        if (period == power) {
+            copyGrid(grid, tortoise);
+            tortoiseHash = hash;
+            power *= 2;
+            period = 0;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Find the first frame of the cycle a simulation falls into, given its
+ * period, by running two grids the period apart until they meet.
+ * @param  grid   the simulation grid
+ * @param  period the number of frames in the cycle
+ * @param  frame  set to the first frame of the cycle
+ * @return the index of the first frame of the cycle
+ */
+long long findPatternStart(const CellBoard& grid, long long period, CellBoard& frame) {
+    copyGrid(grid, frame);
+    advanceGrid(frame, 1);
+    CellBoard ahead;
+    copyGrid(frame, ahead);
+    advanceGrid(ahead, period);
+    uint64_t frameHash = zobristHash(frame);
+    uint64_t aheadHash = zobristHash(ahead);
+    CellBoard next(grid.numRows(), grid.numCols());
+    long long index = 0;
+    while (frameHash != aheadHash || frame != ahead) {
+        stepGrid(frame, next, frameHash);
+        stepGrid(ahead, next, aheadHash);
+        index++;
+    }
+    return index;
+}
+
 /*
  * Calculate the number of living cells in the grid.
  * @param  grid the simulation grid
  * @return the number of living cells
  */
-int numberOfLiveCells(Grid<string> grid) {
-    int numOfLiveCells = 0;
-    for (string cell : grid) {
-        if (cell == "X") {
-            numOfLiveCells ++;
-        }
-    }
-    return numOfLiveCells;
+int64_t numberOfLiveCells(const CellBoard& grid) {
+    return grid.count(ALIVE);
 }
 
 /*
- * Find duplicated grid in a vector of old grids.
- * @param  grid  the grid to look for
- * @param  grids the vector of old generation grids
- * @return the index of the duplicated grid found in the grids vector or -1 if not found
+ * Advance a grid a number of generations without printing it.
+ * @param grid        the simulation grid
+ * @param generations the number of generations to advance by
  */
-int findDuplicatedGrid(Grid<string> grid, Vector<Grid<string>> grids) {
-    for (int i = 0; i < grids.size(); i++) {
-        if (grids[i] == grid) {
-            return i;
-        }
+void advanceGrid(CellBoard& grid, long long generations) {
+    CellBoard next(grid.numRows(), grid.numCols());
+    for (long long i = 0; i < generations; i++) {
+        LifeEngine::advance(grid, next);
+        grid.swap(next);
     }
-    return -1;
 }
 
 /*
- * Run an animation a number of frames.
+ * Advance a grid one generation, keeping its hash up to date.
+ * @param grid the simulation grid
+ * @param next a grid of the same size to compute the generation in
+ * @param hash the hash of grid
+ */
+void stepGrid(CellBoard& grid, CellBoard& next, uint64_t& hash) {
+    uint64_t hashDelta;
+    LifeEngine::advance(grid, next, nullptr, &hashDelta);
+    hash ^= hashDelta;
+    grid.swap(next);
+}
+
+/*
+ * Run an animation a number of frames, a number of generations a frame.
  *
- * Basically tick, wait for 100ms, and repeat these two steps for a number of times.
+ * The generations are computed on this thread and drawn on a render
+ * thread; the two are joined by a triple buffer.  After each frame's
+ * generations this thread publishes a copy of the grid and goes straight
+ * on, and the render thread draws the latest grid published once a frame,
+ * so drawing never holds up the simulation.  When a frame takes longer to
+ * draw than the next one takes to come, the render thread skips the
+ * frames it had no time for.
  *
- * @param frames the number of frames to repeat
- * @param grid   the simulation grid
+ * Each frame's generations are timed, and the number computed a frame
+ * adapts so that a frame is computed in about its share of time: it is
+ * halved after a frame that took longer than frameMs, and doubled, up to
+ * generationsPerFrame, after one that took less than half of it.  Giving
+ * 0 generations a frame starts at 1 and keeps doubling for as long as
+ * there is time, which is how HashLife is fastest, as it remembers jumps
+ * of 2^j generations.  Frames of HASHLIFE_MIN_GENERATIONS or more are
+ * computed with HashLife, except on the unbounded plane.
+ *
+ * @param  frames              the number of frames to repeat
+ * @param  grid                the simulation grid
+ * @param  view                the unbounded plane mode
+ * @param  frameMs             the time a frame is shown for, in milliseconds
+ * @param  generationsPerFrame the most generations a frame, or 0 to double them every frame
+ * @return the number of generations the grid was advanced by
  */
-void animate(int frames, Grid<string>& grid) {
+long long animate(int frames, CellBoard& grid, UnboundedView& view,
+                  int frameMs, long long generationsPerFrame) {
+    long long target = generationsPerFrame > 0 ? min(generationsPerFrame, MAX_GENERATIONS_PER_FRAME)
+                                               : MAX_GENERATIONS_PER_FRAME;
+    long long generations = generationsPerFrame > 0 ? target : 1;
+    HashLife hashLife;
+    bool isUsingHashLife = !view.isOn && grid.size() > 0
+            && (generationsPerFrame == 0 || generationsPerFrame >= HASHLIFE_MIN_GENERATIONS);
+    if (isUsingHashLife) {
+        hashLife.load(grid);
+    }
+
+    CellBoard next(0, 0); // the back buffer of the frames' generations
+
+    TripleBuffer buffer;
+    atomic<bool> finished(false);
+    thread renderer(renderFrames, ref(buffer), cref(finished), frameMs);
+
+    // each frame is due frameMs after the one before; a frame that runs
+    // late moves the ones after it back rather than making them hurry
+    chrono::steady_clock::time_point due = chrono::steady_clock::now();
+    long long total = 0;
+    int stableAt = -1;
     for (int i = 0; i < frames; i++) {
-        bool keepRunning = tick(grid);
-        if (keepRunning) { // the grid is changing (not stable)
-            pause(100);
-            clearConsole();
-        } else { // the grid is stable
-            cout << "animation ended at " << i << " frames because the world is stable." << endl;
+        Timer timer(true);
+        long long advanced = advanceFrame(grid, next, view, isUsingHashLife ? &hashLife : nullptr,
+                                          generations);
+        if (advanced == 0) { // the grid is stable
+            stableAt = i;
             break;
         }
+        long ms = timer.stop();
+        total += advanced;
+        BoardFrame& frame = buffer.back();
+        frame.board = grid;
+        frame.generation = total;
+        buffer.publish();
+
+        if (ms > frameMs) {
+            generations = max(1LL, generations / 2);
+        } else if (ms * 2 < frameMs) {
+            generations = min(target, generations * 2);
+        }
+        due = max(due + chrono::milliseconds(frameMs), chrono::steady_clock::now());
+        this_thread::sleep_until(due);
+    }
+    finished.store(true, memory_order_release);
+    renderer.join();
+    if (stableAt >= 0) {
+        cout << "animation ended at " << stableAt << " frames because the world is stable." << endl;
     }
+    return total;
 }
 
 /*
- * Advance the simulation one generation forward.
- * @param  grid the simulation grid
- * @return true if the grid changes after this generation and false if the grid is stable
+ * Advance the grid by one frame's generations of an animation.
+ * @param  grid        the simulation grid
+ * @param  next        the back buffer to compute each generation in
+ * @param  view        the unbounded plane mode
+ * @param  hashLife    the engine holding the grid to advance it with, or
+ *                     nullptr to advance it a generation at a time
+ * @param  generations the number of generations to advance by
+ * @return the number of generations the grid was advanced by, which is
+ *         fewer than asked for if it became stable, and 0 if it was stable
  */
-bool tick(Grid<string>& grid, bool isPrintingGrid) {
-    Grid<string> copy(0, 0);
-    copyGrid(grid, copy);
-    for (int r = 0; r < grid.numRows(); r++) {
-        for (int c = 0; c < grid.numCols(); c++) {
-            singleCell(copy, grid, r, c);
+long long advanceFrame(CellBoard& grid, CellBoard& next, UnboundedView& view, HashLife* hashLife,
+                       long long generations) {
+    if (hashLife == nullptr) {
+        for (long long i = 0; i < generations; i++) {
+            if (!tick(grid, next, false, &view)) {
+                return i;
+            }
         }
+        return generations;
     }
-    if (grid == copy) { // no change after this generation
-        return false;
-    } else {
-        if (isPrintingGrid) {
-            printGrid(grid);
-        }
-        return true;
+    // every cell but an empty one ages each generation, so a grid is
+    // stable exactly when it is empty, which HashLife stops at
+    long long advanced = (long long) hashLife->advanceUntilEmpty(generations);
+    if (advanced > 0) {
+        hashLife->toBoard(grid);
     }
+    return advanced;
 }
 
 /*
- * Test if a single cell should be killed, created, or stay the same.
- * @param copy the copied version of the simulation grid that stays the same
- * @param grid the simulation grid that is modified
- * @param r    the row index of the cell to test
- * @param c    the column index of the cell to test
+ * The render thread of animate: once every frameMs, draw the latest grid
+ * published to frames if there is a new one, until finished is set, and
+ * then draw the last grid.
+ * On a terminal only the cells that change are redrawn; there is no GUI to
+ * update there, as only a headless build draws on a terminal.  Elsewhere
+ * the whole grid is printed and shown in the GUI.
+ * @param frames   the grids published by the simulation
+ * @param finished set by the simulation once it has published its last grid
+ * @param frameMs  the time between two frames, in milliseconds
  */
-void singleCell(const Grid<string>& copy, Grid<string>& grid, int r, int c) {
-    int numOfNeighbors = getNumOfNeighbors(r, c, copy);
-    if (numOfNeighbors <= 1 || numOfNeighbors >= 4) {
-        degradeCell(r, c, grid);
-    } else if (numOfNeighbors == 2) {
-        generateCell(r, c, grid);
-    } else if (numOfNeighbors == 3) {
-        generateCell(r, c, grid);
+void renderFrames(TripleBuffer& frames, const atomic<bool>& finished, int frameMs) {
+    bool redrawChanges = ConsoleRenderer::isSupported();
+    ConsoleRenderer renderer;
+    bool drawn = false;
+    chrono::steady_clock::time_point next = chrono::steady_clock::now();
+    while (true) {
+        bool last = finished.load(memory_order_acquire);
+        if (frames.update()) {
+            if (redrawChanges) {
+                renderer.render(frames.front().board);
+            } else {
+                if (drawn) {
+                    clearConsole();
+                }
+                printGrid(frames.front().board);
+            }
+            drawn = true;
+        }
+        if (last) {
+            break;
+        }
+        next = max(next + chrono::milliseconds(frameMs), chrono::steady_clock::now());
+        this_thread::sleep_until(next);
     }
+    renderer.finish();
 }
 
 /*
- * Create a new cell at (r, c) in the simulation grid.
- * @param r    the row index of the cell to create
- * @param c    the column index of the cell to create
- * @param grid the simulation grid
+ * Prompt for a frame rate and a number of generations a frame, run an
+ * animation with them, and print how fast the colony went.
+ * @param frames the number of frames to repeat
+ * @param grid   the simulation grid
+ * @param view   the unbounded plane mode
  */
-void generateCell(int r, int c, Grid<string>& grid) {
-    if (grid[r][c] == "-") {
-        grid[r][c] = "X";
-    } else {
-        degradeCell(r, c, grid);
+void pacedAnimation(int frames, CellBoard& grid, UnboundedView& view) {
+    int framesPerSecond = getInteger("Frames per second? ");
+    while (framesPerSecond <= 0 || framesPerSecond > 1000) {
+        framesPerSecond = getInteger("Give a number from 1 to 1000. Frames per second? ");
+    }
+    int generationsPerFrame = getInteger("Generations per frame (0 to keep doubling them)? ");
+    while (generationsPerFrame < 0) {
+        generationsPerFrame = getInteger("Give 0 or more. Generations per frame? ");
     }
+    Timer timer(true);
+    long long generations = animate(frames, grid, view, 1000 / framesPerSecond, generationsPerFrame);
+    long ms = max(1L, timer.stop());
+    cout << generations << " generations in " << ms / 1000.0 << " seconds, "
+         << (long long) (generations * 1000.0 / ms) << " a second." << endl;
 }
 
 /*
- * Kill the cell at (r, c) in the simulation grid.
- * @param r    the row index of the cell to create
- * @param c    the column index of the cell to create
- * @param grid the simulation grid
+ * Skip a number of generations ahead at once with HashLife, and print the
+ * grid that is reached.
+ * HashLife wraps around the edges of the grid, so on the unbounded plane
+ * the generations are computed one at a time instead.  After a HashLife
+ * jump, its cache counters are printed too.
+ * @param generations the number of generations to skip
+ * @param grid        the simulation grid
+ * @param view        the unbounded plane mode
  */
-void degradeCell(int r, int c, Grid<string>& grid) {
-    if (grid[r][c] == "X") {
-        grid[r][c] = "O";
-    } else if (grid[r][c] == "O") {
-        grid[r][c] = "C";
-    } else if (grid[r][c] == "C"){
-        grid[r][c] = "-";
+void jump(int generations, CellBoard& grid, UnboundedView& view) {
+    if (view.isOn) {
+        for (int i = 0; i < generations && !view.plane.isEmpty(); i++) {
+            view.plane.advance();
+        }
+        view.plane.toBoard(grid, view.top, view.left);
+        printGrid(grid);
+        cout << generations << " generations later there are " << view.plane.count(ALIVE)
+             << " living cells." << endl;
+        return;
     }
+    HashLife hashLife;
+    hashLife.load(grid);
+    hashLife.advance(generations);
+    hashLife.toBoard(grid);
+    printGrid(grid);
+    cout << generations << " generations later there are " << hashLife.population()
+         << " living cells." << endl;
+    HashLifeStats stats = hashLife.getStats();
+    cout << "HashLife found " << stats.hits << " results cached and computed " << stats.misses
+         << ", evicted " << stats.evictions << " in " << stats.collections << " collections, and holds "
+         << stats.nodes << " nodes in " << stats.bytes / 1024 << " KB." << endl;
 }
 
 /*
- * Check if the cell at (r, c) in the simulation grid is occupied or not.
- * @param r    the row index of the cell to create
- * @param c    the column index of the cell to create
- * @param copy the copied version of the simulation grid that stays the same
+ * Switch between a grid that wraps around its edges and an unbounded plane
+ * that the grid is a window onto.
+ * Switching back keeps only the cells inside the window.
+ * @param grid the simulation grid
+ * @param view the unbounded plane mode
  */
-bool isCellOccupied(int r, int c, const Grid<string>& copy) {
-    int endRow = copy.numRows() - 1;
-    int endCol = copy.numCols() - 1;
-
-    // wraps around in both dimensions
-    // top-most and bottom-most rows are neighbors
-    if (r == -1) {
-        r = endRow;
-    } else if (r == endRow + 1) {
-        r = 0;
+void toggleUnbounded(CellBoard& grid, UnboundedView& view) {
+    if (!view.isOn) {
+        view.isOn = true;
+        view.top = 0;
+        view.left = 0;
+        view.plane.load(grid, view.top, view.left);
+        cout << "The colony now lives on an unbounded plane; the grid is a window onto it." << endl;
+    } else {
+        view.isOn = false;
+        view.plane.clear();
+        cout << "The grid wraps around its edges again; cells outside the window are gone." << endl;
     }
+}
 
-    // left-most and right-most columns are neighbors
-    if (c == -1) {
-        c = endCol;
-    } else if (c == endCol + 1) {
-        c = 0;
+/*
+ * Move the window onto the unbounded plane and print what it shows.
+ * @param grid the simulation grid
+ * @param view the unbounded plane mode
+ */
+void moveViewport(CellBoard& grid, UnboundedView& view) {
+    if (!view.isOn) {
+        cout << "The viewport can only be moved on the unbounded plane." << endl;
+        return;
     }
+    view.top = getInteger("Top row of the viewport? ");
+    view.left = getInteger("Left column of the viewport? ");
+    view.plane.toBoard(grid, view.top, view.left);
+    printGrid(grid);
+}
 
-    string cell = copy[r][c];
-
-    if (cell == "X") {
-        return true;
-    } else if (cell == "O") {
-        return true;
-    } else if (cell == "C") {
-        return false;
-    } else {
-        return false;
+/*
+ * Zoom and move the GUI's view of the grid.  A zoom of n shows each cell
+ * n pixels wide, -n shows 2^n x 2^n cells in each pixel, and 0 fits the
+ * whole grid in the window.
+ * @param grid the simulation grid
+ */
+void zoomGUI(const CellBoard& grid) {
+    int zoom = getInteger("Zoom (pixels per cell, -n for 2^n cells per pixel, 0 to fit)? ");
+    int row = grid.numRows() / 2;
+    int col = grid.numCols() / 2;
+    if (zoom != 0) {
+        row = getInteger("Row at the center of the view? ");
+        col = getInteger("Column at the center of the view? ");
     }
+    updateGUI(grid);
+    LifeGUI::setView(zoom, row, col);
+    LifeGUI::repaint();
 }
 
 /*
- * Get the number of neighbors of the cell at (r, c) in the grid.
- * @param r    the row index of the cell to create
- * @param c    the column index of the cell to create
- * @param copy the copied version of the simulation grid that stays the same
+ * Advance the simulation one generation forward.
+ * On the unbounded plane the whole plane is advanced and grid is set to the
+ * window onto it.
+ * @param  grid the simulation grid
+ * @param  next the back buffer to compute the generation in, which the
+ *              caller keeps between generations; it is resized to grid's
+ *              size if it is not that size already
+ * @param  view the unbounded plane mode, or nullptr to wrap around the edges
+ * @return true if the grid changes after this generation and false if the grid is stable
  */
-int getNumOfNeighbors(int r, int c, const Grid<string>& copy) {
-    return isCellOccupied(r - 1, c - 1, copy) + isCellOccupied(r - 1, c + 1, copy) +
-            isCellOccupied(r + 1, c - 1, copy) + isCellOccupied(r + 1, c + 1, copy) +
-            isCellOccupied(r - 1, c, copy) + isCellOccupied(r + 1, c, copy) +
-            isCellOccupied(r, c - 1, copy) + isCellOccupied(r, c + 1, copy);
+bool tick(CellBoard& grid, CellBoard& next, bool isPrintingGrid, UnboundedView* view) {
+    if (view != nullptr && view->isOn) {
+        if (view->plane.isEmpty()) { // nothing left anywhere on the plane
+            return false;
+        }
+        view->plane.advance();
+        view->plane.toBoard(grid, view->top, view->left);
+        if (isPrintingGrid) {
+            printGrid(grid);
+        }
+        return true;
+    }
+    // the next generation goes into the caller's back buffer, and the
+    // engine reports whether anything changed as it computes it
+    if (next.numRows() != grid.numRows() || next.numCols() != grid.numCols()) {
+        next.resize(grid.numRows(), grid.numCols());
+    }
+    if (!LifeEngine::advance(grid, next)) { // no change after this generation
+        return false;
+    }
+    grid.swap(next);
+    if (isPrintingGrid) {
+        printGrid(grid);
+    }
+    return true;
 }
 
 /*
@@ -454,35 +878,22 @@ int getNumOfNeighbors(int r, int c, const Grid<string>& copy) {
  * @param original the grid to copy from
  * @param copy     the new grid to copy to
  */
-void copyGrid(const Grid<string>& original, Grid<string>& copy) {
-    copy.resize(original.numRows(), original.numCols());
-    for (int r = 0; r < original.numRows(); r ++) {
-        for (int c = 0; c < original.numCols(); c ++) {
-            copy[r][c] = original[r][c];
-        }
-    }
+void copyGrid(const CellBoard& original, CellBoard& copy) {
+    copy = original;
 }
 
 /*
  * Print a grid in 2D in both the console and GUI
  * @param grid the grid to print
  */
-void printGrid(const Grid<string>& grid) {
-    LifeGUI::resize(grid.numRows(), grid.numCols());
-    string output = "";
+void printGrid(const CellBoard& grid) {
+    string output;
+    output.reserve((grid.numCols() + 1) * grid.numRows());
     for (int r = 0; r < grid.numRows(); r ++) {
-        for (int c = 0; c < grid.numCols(); c ++) {
-            output += grid[r][c];
-            if (grid[r][c] == "X") { // black
-                LifeGUI::fillCell(r, c, "#000000");
-            } else if (grid[r][c] == "O") { // dimgray
-                LifeGUI::fillCell(r, c, "#696969");
-            } else if (grid[r][c] == "C") { // lightgray
-                LifeGUI::fillCell(r, c, "#D3D3D3");
-            }
-        }
+        output += grid.rowToString(r);
         output += "\n";
     }
     cout << output << flush;
+    updateGUI(grid);
     LifeGUI::repaint();
 }
@@ -0,0 +1,142 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the LifeEngine class.
+ * See lifeengine.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "lifeengine.h"
+#include <algorithm>
+#include <thread>
+#include "lifekernel.h"
+
+using namespace std;
+
+ThreadPool* LifeEngine::pool = nullptr;
+TileScheduler* LifeEngine::tileScheduler = nullptr;
+int LifeEngine::threadCount = 0;
+Schedule LifeEngine::schedule = SCHEDULE_TILES;
+vector<uint64_t> LifeEngine::columns;
+vector<char> LifeEngine::bandChanged;
+vector<RegionCounts> LifeEngine::bandCounts;
+vector<uint64_t> LifeEngine::bandHashes;
+TileStats LifeEngine::tileStats = TileStats();
+
+// boards smaller than this are not worth waking the workers for
+const int LifeEngine::MIN_PARALLEL_CELLS = 64 * 1024;
+
+LifeEngine::LifeEngine() {
+    // empty
+}
+
+bool LifeEngine::advance(const CellBoard& src, CellBoard& dst, RegionCounts* counts,
+                         uint64_t* hashDelta) {
+    bool parallel = src.size() >= MIN_PARALLEL_CELLS;
+    tileStats = TileStats();
+    if (schedule == SCHEDULE_TILES) {
+        if (!tileScheduler) {
+            tileScheduler = new TileScheduler();
+        }
+        bool changed = tileScheduler->advance(threadPool(), parallel ? getThreadCount() : 1,
+                                              src, dst, counts, hashDelta);
+        tileStats = tileScheduler->getStats();
+        return changed;
+    }
+
+    int rows = src.numRows();
+    int bands = std::min(getThreadCount(), rows);
+    if (counts) {
+        clearCounts(*counts);
+    }
+    if (hashDelta) {
+        *hashDelta = 0;
+    }
+    if (bands <= 1 || !parallel) {
+        return advanceRows(src, dst, 0, rows, columns, counts, hashDelta);
+    }
+
+    // every band has its own column buffers, counts, and hash, all kept
+    // from one generation to the next
+    int words = src.wordsPerRow();
+    dst.discardTileSummary();
+    columns.resize((size_t) bands * 2 * words);
+    std::fill(columns.begin(), columns.end(), 0);
+    bandChanged.assign(bands, false);
+    bandCounts.resize(bands);
+    bandHashes.assign(bands, 0);
+    // the job is captured by a single reference, which std::function holds
+    // without allocating
+    struct BandJob {
+        const CellBoard& src;
+        CellBoard& dst;
+        bool counting;
+        bool hashing;
+    } job = {src, dst, counts != nullptr, hashDelta != nullptr};
+    threadPool().run(bands, [&job](int band) {
+        int rows = job.src.numRows();
+        int bands = (int) bandChanged.size();
+        int words = job.src.wordsPerRow();
+        int rowStart = (int) ((long long) rows * band / bands);
+        int rowEnd = (int) ((long long) rows * (band + 1) / bands);
+        uint64_t* columnHigh = &columns[(size_t) band * 2 * words];
+        clearCounts(bandCounts[band]);
+        bandChanged[band] = advanceRegion(job.src, job.dst, rowStart, rowEnd, 0, words,
+                                          columnHigh, columnHigh + words,
+                                          job.counting ? &bandCounts[band] : nullptr,
+                                          job.hashing ? &bandHashes[band] : nullptr);
+    });
+    for (int band = 0; band < bands; band++) {
+        if (counts) {
+            addCounts(*counts, bandCounts[band]);
+        }
+        if (hashDelta) {
+            *hashDelta ^= bandHashes[band];
+        }
+    }
+    return std::find(bandChanged.begin(), bandChanged.end(), true) != bandChanged.end();
+}
+
+void LifeEngine::setThreadCount(int threads) {
+    if (threads < 0) {
+        threads = 0;
+    }
+    if (threads != threadCount) {
+        shutdown();
+        threadCount = threads;
+    }
+}
+
+int LifeEngine::getThreadCount() {
+    if (threadCount > 0) {
+        return threadCount;
+    }
+    return std::max(1, (int) thread::hardware_concurrency());
+}
+
+void LifeEngine::setSchedule(Schedule schedule) {
+    LifeEngine::schedule = schedule;
+}
+
+Schedule LifeEngine::getSchedule() {
+    return schedule;
+}
+
+TileStats LifeEngine::getTileStats() {
+    return tileStats;
+}
+
+void LifeEngine::shutdown() {
+    delete pool;
+    pool = nullptr;
+}
+
+/*
+ * Returns the worker pool, starting it on first use.
+ */
+ThreadPool& LifeEngine::threadPool() {
+    if (!pool) {
+        pool = new ThreadPool(getThreadCount());
+    }
+    return *pool;
+}
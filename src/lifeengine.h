@@ -0,0 +1,111 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the LifeEngine class, which advances a board one
+ * generation at a time on all available cores.
+ * See lifeengine.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _lifeengine_h
+#define _lifeengine_h
+
+#include <cstdint>
+#include <vector>
+#include "cellboard.h"
+#include "lifekernel.h"
+#include "threadpool.h"
+#include "tilescheduler.h"
+
+/**
+ * The ways LifeEngine can divide a generation between threads.
+ */
+enum Schedule {
+    SCHEDULE_BANDS,     // the whole board, one fixed band of rows per thread
+    SCHEDULE_TILES      // only the active 64x64 tiles, with work stealing
+};
+
+/**
+ * The LifeEngine class advances a board in parallel on a persistent thread
+ * pool.  By default it hands the work to a TileScheduler, which keeps track
+ * of the active region of the board and recomputes only that, so quiet or
+ * empty parts of a board cost next to nothing.  With SCHEDULE_BANDS it
+ * instead recomputes the whole board, split into horizontal bands of rows,
+ * one per thread.
+ *
+ * Each band or tile reads the cells just around it (its halo) straight
+ * from the previous generation, which is never written during a
+ * generation, so threads never need to exchange data or lock; the pool's
+ * barrier at the end of each generation is the only synchronization.
+ * Every output cell is produced by exactly one thread with the same
+ * kernel, so the result does not depend on the number of threads.
+ */
+class LifeEngine {
+public:
+    /**
+     * Computes the generation after src into dst.
+     * dst must have the same dimensions as src and must not be src.
+     * Returns true if dst differs from src; the kernels work this out as
+     * they go, so there is no need to compare the boards afterwards.
+     * If counts is given, it is set to the births and the extent of the
+     * cells of dst, counted by the kernels as they go too.
+     * If hashDelta is given, it is set to the Zobrist hash of src XORed
+     * with that of dst, from just the words that changed.
+     */
+    static bool advance(const CellBoard& src, CellBoard& dst, RegionCounts* counts = nullptr,
+                        std::uint64_t* hashDelta = nullptr);
+
+    /**
+     * Sets the number of threads used to advance a board.
+     * Passing 0 uses one thread per hardware core.
+     */
+    static void setThreadCount(int threads);
+
+    /**
+     * Returns the number of threads used to advance a board.
+     */
+    static int getThreadCount();
+
+    /**
+     * Sets/returns how a generation is divided between threads.
+     */
+    static void setSchedule(Schedule schedule);
+    static Schedule getSchedule();
+
+    /**
+     * Returns the active-region and load-balance statistics of the most
+     * recent generation advanced; they are reset by every call to advance,
+     * so they are all 0 if that generation was not advanced with
+     * SCHEDULE_TILES.
+     */
+    static TileStats getTileStats();
+
+    /**
+     * Stops the worker threads.  They are restarted on the next advance.
+     * Clients generally do not need to call this.
+     */
+    static void shutdown();
+
+private:
+    /*
+     * Private constructor prevents client construction.
+     * This class is meant to be accessed via static methods.
+     */
+    LifeEngine();
+
+    static ThreadPool& threadPool();
+
+    /* private internal data; clients should not use/modify these */
+    static ThreadPool* pool;
+    static TileScheduler* tileScheduler;
+    static int threadCount;
+    static Schedule schedule;
+    static TileStats tileStats;     // of the generation advanced last
+    static std::vector<std::uint64_t> columns;      // the kernels' column buffers, for each band
+    static std::vector<char> bandChanged;           // what each band found, with SCHEDULE_BANDS
+    static std::vector<RegionCounts> bandCounts;
+    static std::vector<std::uint64_t> bandHashes;
+    static const int MIN_PARALLEL_CELLS;
+};
+
+#endif // _lifeengine_h
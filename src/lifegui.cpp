@@ -15,9 +15,14 @@
  */
 
 #include "lifegui.h"
+#include <algorithm>
 #include <cmath>
 #include "error.h"
+#ifndef SPL_HEADLESS_MODE
+#include "gcolor.h"
+#include "grid.h"
 #include "gwindow.h"
+#endif // SPL_HEADLESS_MODE
 #include "map.h"
 
 using namespace std;
@@ -33,64 +38,347 @@ int LifeGUI::upperLeftY = 0;
 bool LifeGUI::isEnabled = true;
 bool LifeGUI::isInitialized = false;
 bool LifeGUI::isToBack = false;
+int LifeGUI::boardWidth = 0;
+int LifeGUI::boardHeight = 0;
+int LifeGUI::canvasWidth = 0;
+int LifeGUI::canvasHeight = 0;
+vector<int> LifeGUI::pixels;
+vector<int> LifeGUI::background;
+vector<bool> LifeGUI::cellShape;
+string LifeGUI::lastColor;
+int LifeGUI::lastColorARGB = 0;
+vector<int> LifeGUI::dirtyCells;
+bool LifeGUI::allDirty = false;
+int LifeGUI::zoom = 0;
+int LifeGUI::centerRow = 0;
+int LifeGUI::centerCol = 0;
+int LifeGUI::cellsPerPixel = 1;
+int LifeGUI::viewTop = 0;
+int LifeGUI::viewLeft = 0;
+int LifeGUI::viewRows = 0;
+int LifeGUI::viewCols = 0;
+CellBoard LifeGUI::shown;
+DensityMap LifeGUI::density;
+bool LifeGUI::isDensityCurrent = false;
 
 LifeGUI::LifeGUI() {
     // empty
 }
 
+#ifdef SPL_HEADLESS_MODE
+
+// no window to draw in; see lifegui.h
+void LifeGUI::clear() {}
+void LifeGUI::clearCell(int, int) {}
+void LifeGUI::drawBoard(const CellBoard&) {}
+void LifeGUI::fillCell(int, int, string) {}
+void LifeGUI::initialize() {}
+bool LifeGUI::isSized(int, int) {
+    return true;
+}
+void LifeGUI::repaint() {}
+void LifeGUI::resize(int, int) {}
+void LifeGUI::screenshot(const std::string&) {}
+void LifeGUI::setCell(int, int, string) {}
+void LifeGUI::setEnabled(bool enabled) {
+    isEnabled = enabled;
+}
+void LifeGUI::setToBack(bool toBack) {
+    isToBack = toBack;
+}
+void LifeGUI::setView(int, int, int) {}
+void LifeGUI::shutdown() {}
+
+#else // SPL_HEADLESS_MODE
+
+// opaque ARGB colors of the board's frame
+static const int WHITE_ARGB = (int) 0xffffffff;
+static const int BLACK_ARGB = (int) 0xff000000;
+static const int GRAY_ARGB = (int) 0xff808080;
+
+// the colors drawBoard draws cells of each state in: -, C, O, X
+static const int CELL_ARGB[4] = {WHITE_ARGB, (int) 0xffd3d3d3, (int) 0xff696969, BLACK_ARGB};
+
+// cells narrower than this many pixels get no grid lines between them
+static const int MIN_GRID_LINE_CELL = 4;
+
+// the view zooms out to at most 2^MAX_ZOOM_OUT cells on a side of a pixel
+static const int MAX_ZOOM_OUT = 30;
+
+// the pixel buffer in the form the canvas takes it, kept between repaints
+static Grid<int> canvasPixels;
+
 void LifeGUI::clear() {
     if (!isEnabled) {
         return;
     }
     initialize();
+    pixels = background;
+    dirtyCells.clear();
+    allDirty = true;
+    shown.resize(0, 0);
+}
 
-    // clear window
-    window->setColor("white");
-    window->fillRect(0, 0,
-                     window->getWidth() + 1,
-                     window->getHeight() + 1);
-    window->setColor("black");
+void LifeGUI::clearCell(int row, int col) {
+    if (!isEnabled) {
+        return;
+    }
+    initialize();
+    checkCell(row, col, "clearCell");
+    if (!isInView(row, col)) {
+        return;
+    }
+    eraseCell(row, col);
+    dirtyCells.push_back(cellPixel(row, col));
+}
 
-    // draw black rect around board area
-    window->drawRect(upperLeftX, upperLeftY,
-                     cols * cellDiameter,
-                     rows * cellDiameter);
+/*
+ * Draws the white canvas into the background buffer, with a black
+ * rectangle around the board area and gray grid lines between the cells
+ * in view if they are big enough for the lines to help; and works out which
+ * pixels of a cell fillCell colors, so that cells are drawn as circles.
+ */
+void LifeGUI::drawBackground() {
+    background.assign((size_t) canvasWidth * canvasHeight, WHITE_ARGB);
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    int left = upperLeftX - 1;
+    int top = upperLeftY - 1;
+    int right = std::min(upperLeftX + boardWidth, canvasWidth - 1);
+    int bottom = std::min(upperLeftY + boardHeight, canvasHeight - 1);
+    if (cellDiameter >= MIN_GRID_LINE_CELL) {
+        for (int r = 1; r < viewRows; r++) {   // horizontal
+            int* line = &background[(size_t) (upperLeftY + r * cellDiameter) * canvasWidth];
+            std::fill(line + left + 1, line + right, GRAY_ARGB);
+        }
+        for (int c = 1; c < viewCols; c++) {   // vertical
+            for (int y = top + 1; y < bottom; y++) {
+                background[(size_t) y * canvasWidth + upperLeftX + c * cellDiameter] = GRAY_ARGB;
+            }
+        }
+    }
+    for (int x = left; x <= right; x++) {
+        background[(size_t) top * canvasWidth + x] = BLACK_ARGB;
+        background[(size_t) bottom * canvasWidth + x] = BLACK_ARGB;
+    }
+    for (int y = top; y <= bottom; y++) {
+        background[(size_t) y * canvasWidth + left] = BLACK_ARGB;
+        background[(size_t) y * canvasWidth + right] = BLACK_ARGB;
+    }
 
-    // draw grid lines
-    window->setColor("gray");
-    for (int r = 1; r < rows; r++) {   // horizontal
-        window->drawLine(upperLeftX + 1,
-                         upperLeftY + r * cellDiameter,
-                         upperLeftX + cols * cellDiameter - 1,
-                         upperLeftY + r * cellDiameter);
+    // a circle one pixel in from the cell's edges, or the whole cell when
+    // it is too small for a circle to show
+    int d = std::max(cellDiameter, 1);
+    cellShape.assign((size_t) d * d, true);
+    if (d >= MIN_GRID_LINE_CELL) {
+        double radius = (d - 2) / 2.0;
+        for (int y = 0; y < d; y++) {
+            for (int x = 0; x < d; x++) {
+                double dx = x + 0.5 - d / 2.0;
+                double dy = y + 0.5 - d / 2.0;
+                cellShape[(size_t) y * d + x] = dx * dx + dy * dy <= radius * radius;
+            }
+        }
     }
-    for (int c = 1; c < cols; c++) {   // vertical
-        window->drawLine(upperLeftX + c * cellDiameter,
-                         upperLeftY + 1,
-                         upperLeftX + c * cellDiameter,
-                         upperLeftY + rows * cellDiameter - 1);
+}
+
+void LifeGUI::drawBoard(const CellBoard& board) {
+    if (!isEnabled) {
+        return;
+    }
+    initialize();
+    if (!isSized(board.numRows(), board.numCols())
+            || shown.numRows() != board.numRows() || shown.numCols() != board.numCols()) {
+        resize(board.numRows(), board.numCols());
+        shown.resize(board.numRows(), board.numCols());
+    }
+    if (cellDiameter == 0) {
+        shown = board;
+        isDensityCurrent = false;
+        drawDensity();
+        return;
     }
-    window->setColor("black");
+
+    // redraw the cells in view that changed, a word of each row at a time
+    int right = viewLeft + viewCols;
+    for (int r = viewTop; r < viewTop + viewRows; r++) {
+        const uint64_t* high = board.highRow(r);
+        const uint64_t* low = board.lowRow(r);
+        const uint64_t* shownHigh = shown.highRow(r);
+        const uint64_t* shownLow = shown.lowRow(r);
+        for (int w = viewLeft / CellBoard::CELLS_PER_WORD; w <= (right - 1) / CellBoard::CELLS_PER_WORD; w++) {
+            uint64_t changed = (high[w] ^ shownHigh[w]) | (low[w] ^ shownLow[w]);
+            int from = viewLeft - w * CellBoard::CELLS_PER_WORD;
+            int to = right - w * CellBoard::CELLS_PER_WORD;
+            if (from > 0) {
+                changed &= ~uint64_t(0) << from;
+            }
+            if (to < CellBoard::CELLS_PER_WORD) {
+                changed &= (uint64_t(1) << to) - 1;
+            }
+            while (changed) {
+                int c = w * CellBoard::CELLS_PER_WORD + popcount64((changed & (~changed + 1)) - 1);
+                changed &= changed - 1;
+                CellState cell = board.get(r, c);
+                eraseCell(r, c);
+                if (cell != EMPTY) {
+                    paintCell(r, c, CELL_ARGB[cell]);
+                }
+                dirtyCells.push_back(cellPixel(r, c));
+            }
+        }
+    }
+    shown = board;
+    isDensityCurrent = false;
 }
 
 /*
- *
+ * Draws the view of the board drawBoard drew last afresh over the
+ * background; there is nothing to draw if it was not drawn on this layout.
+ */
+void LifeGUI::drawView() {
+    pixels = background;
+    dirtyCells.clear();
+    allDirty = true;
+    if (shown.numRows() != rows || shown.numCols() != cols) {
+        return;
+    }
+    if (cellDiameter == 0) {
+        drawDensity();
+        return;
+    }
+    for (int r = viewTop; r < viewTop + viewRows; r++) {
+        for (int c = viewLeft; c < viewLeft + viewCols; c++) {
+            CellState cell = shown.get(r, c);
+            if (cell != EMPTY) {
+                paintCell(r, c, CELL_ARGB[cell]);
+            }
+        }
+    }
+}
+
+/*
+ * Shades each pixel of a zoomed-out view by the weight of the cells it
+ * covers, from white for empty cells to black for living ones.  The
+ * weights of squares of DensityMap::BLOCK_SIZE cells and up are looked up
+ * in the density map, which is built again only after the board changed;
+ * smaller squares are counted from the board, a row word at a time.  The
+ * shade goes with the square root of the weight, so that sparse colonies,
+ * which most are, still show up.
  */
+void LifeGUI::drawDensity() {
+    if (shown.numRows() != rows || shown.numCols() != cols) {
+        return;
+    }
+    bool isUsingMap = cellsPerPixel >= DensityMap::BLOCK_SIZE;
+    if (isUsingMap && !isDensityCurrent) {
+        density.build(shown);
+        isDensityCurrent = true;
+    }
+    int level = 0;
+    for (int size = DensityMap::BLOCK_SIZE; size < cellsPerPixel; size *= 2) {
+        level++;
+    }
+    double maxWeight = 3.0 * cellsPerPixel * cellsPerPixel;
+    for (int y = 0; y < boardHeight; y++) {
+        int* line = &pixels[(size_t) (upperLeftY + y) * canvasWidth + upperLeftX];
+        int row = viewTop + y * cellsPerPixel;
+        for (int x = 0; x < boardWidth; x++) {
+            int col = viewLeft + x * cellsPerPixel;
+            uint32_t weight = isUsingMap
+                    ? density.weight(level, row / cellsPerPixel, col / cellsPerPixel)
+                    : DensityMap::blockWeight(shown, row, col, cellsPerPixel);
+            int gray = 255 - (int) (255 * sqrt(weight / maxWeight) + 0.5);
+            line[x] = BLACK_ARGB | gray << 16 | gray << 8 | gray;
+        }
+    }
+    allDirty = true;
+}
+
 void LifeGUI::fillCell(int row, int col, string color) {
     if (!isEnabled) {
         return;
     }
     initialize();
+    checkCell(row, col, "fillCell");
+    if (!isInView(row, col)) {
+        return;
+    }
+    paintCell(row, col, colorToARGB(color));
+    dirtyCells.push_back(cellPixel(row, col));
+}
+
+/*
+ * Throws an error if the given cell is not on the board.
+ */
+void LifeGUI::checkCell(int row, int col, const string& caller) {
     if (row < 0 || row >= rows || col < 0 || col >= cols) {
-        error("LifeGUI::fillCell illegal row/col");
+        error("LifeGUI::" + caller + " illegal row/col");
+    }
+}
+
+/*
+ * Returns the opaque ARGB value of a color name or "#rrggbb" string,
+ * remembering the last one, as cells mostly come in runs of one color.
+ */
+int LifeGUI::colorToARGB(const string& color) {
+    if (color != lastColor) {
+        lastColorARGB = GColor::convertColorToRGB(color) | BLACK_ARGB;
+        lastColor = color;
+    }
+    return lastColorARGB;
+}
+
+/*
+ * Returns true if a cell of the board is in the view.
+ */
+bool LifeGUI::isInView(int row, int col) {
+    return row >= viewTop && row < viewTop + viewRows && col >= viewLeft && col < viewLeft + viewCols;
+}
+
+/*
+ * Returns the index in the pixel buffer of the top-left pixel of a cell in
+ * view.  When the view is zoomed out, each pixel stands for several cells
+ * and shows the one drawn on it last.
+ */
+int LifeGUI::cellPixel(int row, int col) {
+    if (cellDiameter == 0) {
+        int x = upperLeftX + (col - viewLeft) / cellsPerPixel;
+        int y = upperLeftY + (row - viewTop) / cellsPerPixel;
+        return y * canvasWidth + x;
+    }
+    return (upperLeftY + (row - viewTop) * cellDiameter) * canvasWidth
+            + upperLeftX + (col - viewLeft) * cellDiameter;
+}
+
+/*
+ * Colors the pixels of a cell's circle in the pixel buffer.
+ */
+void LifeGUI::paintCell(int row, int col, int argb) {
+    int corner = cellPixel(row, col);
+    int size = std::max(cellDiameter, 1);
+    for (int dy = 0; dy < size; dy++) {
+        int* line = &pixels[(size_t) corner + (size_t) dy * canvasWidth];
+        for (int dx = 0; dx < size; dx++) {
+            if (cellShape[(size_t) dy * size + dx]) {
+                line[dx] = argb;
+            }
+        }
+    }
+}
+
+/*
+ * Puts back the background pixels of a cell in the pixel buffer.
+ */
+void LifeGUI::eraseCell(int row, int col) {
+    int corner = cellPixel(row, col);
+    int size = std::max(cellDiameter, 1);
+    for (int dy = 0; dy < size; dy++) {
+        size_t start = (size_t) corner + (size_t) dy * canvasWidth;
+        std::copy(background.begin() + start, background.begin() + start + size,
+                  pixels.begin() + start);
     }
-    string currentColor = window->getColor();
-    window->setColor(color);
-    window->fillOval(upperLeftX + col * cellDiameter + 1,
-                     upperLeftY + row * cellDiameter + 1,
-                     cellDiameter - 2,
-                     cellDiameter - 2);
-    window->setColor(currentColor);
 }
 
 void LifeGUI::initialize() {
@@ -115,12 +403,130 @@ void LifeGUI::initialize() {
     }
 }
 
+bool LifeGUI::isSized(int rows, int cols) {
+    if (!isEnabled) {
+        return true;
+    }
+    initialize();
+    return rows == LifeGUI::rows && cols == LifeGUI::cols && !background.empty()
+            && (int) window->getCanvasSize().getWidth() == canvasWidth
+            && (int) window->getCanvasSize().getHeight() == canvasHeight;
+}
+
+/*
+ * Works out the view from the zoom and center, and where the board area
+ * goes on the canvas: it is as large as fits, leaving room for the black
+ * rectangle, and centered.  Fitting the whole board makes the cells as
+ * large as fits, or, for a board with more cells than the canvas has
+ * pixels, zooms out by the smallest power of two that fits it.  Zoomed
+ * out, the view starts at a multiple of cellsPerPixel, so that its pixels
+ * line up with the blocks of the density map.
+ */
+void LifeGUI::layout() {
+    cellDiameter = 0;
+    cellsPerPixel = 1;
+    viewTop = 0;
+    viewLeft = 0;
+    viewRows = 0;
+    viewCols = 0;
+    boardWidth = 0;
+    boardHeight = 0;
+    int width = canvasWidth - 2;
+    int height = canvasHeight - 2;
+    if (rows > 0 && cols > 0 && width > 0 && height > 0) {
+        if (zoom == 0) {
+            centerRow = rows / 2;
+            centerCol = cols / 2;
+            cellDiameter = std::min(width / cols, height / rows);
+            if (cellDiameter == 0) {
+                cellsPerPixel = 2;
+                while ((cols - 1) / cellsPerPixel + 1 > width || (rows - 1) / cellsPerPixel + 1 > height) {
+                    cellsPerPixel *= 2;
+                }
+            }
+        } else if (zoom > 0) {
+            cellDiameter = std::min(zoom, std::min(width, height));
+        } else {
+            // no further out than it takes to show the board as one pixel
+            cellsPerPixel = 1 << std::min(-zoom, MAX_ZOOM_OUT);
+            while (cellsPerPixel > 2 && cellsPerPixel / 2 >= std::max(rows, cols)) {
+                cellsPerPixel /= 2;
+            }
+        }
+        if (cellDiameter > 0) {
+            viewRows = std::min(rows, height / cellDiameter);
+            viewCols = std::min(cols, width / cellDiameter);
+        } else {
+            viewRows = (int) std::min((long long) rows, (long long) height * cellsPerPixel);
+            viewCols = (int) std::min((long long) cols, (long long) width * cellsPerPixel);
+        }
+        viewTop = std::max(0, std::min(centerRow - viewRows / 2, rows - viewRows));
+        viewLeft = std::max(0, std::min(centerCol - viewCols / 2, cols - viewCols));
+        if (cellDiameter > 0) {
+            boardWidth = viewCols * cellDiameter;
+            boardHeight = viewRows * cellDiameter;
+        } else {
+            viewTop -= viewTop % cellsPerPixel;
+            viewLeft -= viewLeft % cellsPerPixel;
+            boardWidth = (viewCols - 1) / cellsPerPixel + 1;
+            boardHeight = (viewRows - 1) / cellsPerPixel + 1;
+        }
+    }
+    upperLeftX = std::max(1, (canvasWidth - boardWidth) / 2);
+    upperLeftY = std::max(1, (canvasHeight - boardHeight) / 2);
+}
+
 void LifeGUI::repaint() {
     if (!isEnabled) {
         return;
     }
     initialize();
-    window->repaint();
+    if (pixels.empty()) {
+        window->repaint();
+        dirtyCells.clear();
+        allDirty = false;
+        return;
+    }
+    if (!allDirty && dirtyCells.empty()) {
+        return;
+    }
+    // the canvas takes pixels one blocking call at a time or all at once,
+    // so the whole buffer always goes in one call; only the changed cells
+    // are copied into it, and only the rectangle around them is repainted
+    if (canvasPixels.numRows() != canvasHeight || canvasPixels.numCols() != canvasWidth) {
+        canvasPixels.resize(canvasHeight, canvasWidth);
+        allDirty = true;
+    }
+    GCanvas* canvas = window->getCanvas();
+    if (allDirty) {
+        std::copy(pixels.begin(), pixels.end(), canvasPixels.begin());
+        canvas->setPixelsARGB(canvasPixels);
+        window->repaint();
+    } else {
+        int size = std::max(cellDiameter, 1);
+        int left = canvasWidth;
+        int top = canvasHeight;
+        int right = 0;
+        int bottom = 0;
+        for (int corner : dirtyCells) {
+            int x = corner % canvasWidth;
+            int y = corner / canvasWidth;
+            for (int dy = 0; dy < size; dy++) {
+                const int* row = &pixels[(size_t) (y + dy) * canvasWidth + x];
+                for (int dx = 0; dx < size; dx++) {
+                    canvasPixels[y + dy][x + dx] = row[dx];
+                }
+            }
+            left = std::min(left, x);
+            top = std::min(top, y);
+            right = std::max(right, x + size);
+            bottom = std::max(bottom, y + size);
+        }
+        canvas->setPixelsARGB(canvasPixels);
+        canvas->repaintRegion(left, top, right - left, bottom - top);
+    }
+    dirtyCells.clear();
+    allDirty = false;
 }
 
 void LifeGUI::resize(int rows, int cols) {
@@ -128,17 +534,23 @@ void LifeGUI::resize(int rows, int cols) {
         return;
     }
     initialize();
+    int width = (int) window->getCanvasSize().getWidth();
+    int height = (int) window->getCanvasSize().getHeight();
+    if (rows == LifeGUI::rows && cols == LifeGUI::cols && !background.empty()
+            && width == canvasWidth && height == canvasHeight) {
+        // the background drawn last time is still right
+        LifeGUI::clear();
+        return;
+    }
+    if (rows != LifeGUI::rows || cols != LifeGUI::cols) {
+        zoom = 0;
+    }
     LifeGUI::rows = rows;
     LifeGUI::cols = cols;
-
-    // calculate size of each cell
-    double canvasWidth = window->getCanvasSize().getWidth();
-    double canvasHeight = window->getCanvasSize().getHeight();
-    int hPixelsPerCell = canvasHeight / rows;
-    int wPixelsPerCell = canvasWidth / cols;
-    cellDiameter = std::min(wPixelsPerCell, hPixelsPerCell);
-    upperLeftX = std::max(1.0, (canvasWidth - cols * cellDiameter) / 2);
-    upperLeftY = std::max(1.0, (canvasHeight - rows * cellDiameter) / 2);
+    canvasWidth = width;
+    canvasHeight = height;
+    layout();
+    drawBackground();
     LifeGUI::clear();
 }
 
@@ -147,6 +559,19 @@ void LifeGUI::screenshot(const std::string& filename) {
     window->saveCanvasPixels(filename);
 }
 
+void LifeGUI::setCell(int row, int col, string color) {
+    if (!isEnabled) {
+        return;
+    }
+    initialize();
+    checkCell(row, col, "setCell");
+    if (!isInView(row, col)) {
+        return;
+    }
+    eraseCell(row, col);
+    paintCell(row, col, colorToARGB(color));
+    dirtyCells.push_back(cellPixel(row, col));
+}
 
 void LifeGUI::setEnabled(bool enabled) {
     isEnabled = enabled;
@@ -156,6 +581,19 @@ void LifeGUI::setToBack(bool toBack) {
     isToBack = toBack;
 }
 
+void LifeGUI::setView(int zoom, int centerRow, int centerCol) {
+    if (!isEnabled) {
+        return;
+    }
+    initialize();
+    LifeGUI::zoom = zoom;
+    LifeGUI::centerRow = centerRow;
+    LifeGUI::centerCol = centerCol;
+    layout();
+    drawBackground();
+    drawView();
+}
+
 void LifeGUI::shutdown() {
     if (window) {
         window->setExitOnClose(false);
@@ -166,3 +604,5 @@ void LifeGUI::shutdown() {
         window = nullptr;
     }
 }
+
+#endif // SPL_HEADLESS_MODE
@@ -17,12 +17,30 @@
 #ifndef _lifegui_h
 #define _lifegui_h
 
+#include <vector>
+#include "cellboard.h"
+#include "densitymap.h"
+#ifndef SPL_HEADLESS_MODE
 #include "gwindow.h"
+#else
+#include <string>
+class GWindow;
+#endif // SPL_HEADLESS_MODE
 
 using namespace std;
 
 /**
  * The LifeGUI class is a graphical user interface for the Game of Life program.
+ * Cells are drawn into an ARGB pixel buffer the size of the canvas, which
+ * is handed to the canvas in one piece by repaint, so drawing a generation
+ * costs a few pixel writes per cell and one blit.
+ * The window shows a view of the board that can be zoomed and moved with
+ * setView.  Zoomed in, a cell is a square of pixels; zoomed out, a pixel
+ * is a square of 2^n x 2^n cells, shaded by how full that square is, which
+ * is looked up in a DensityMap of the board, so drawing a view costs in
+ * proportion to the pixels it covers rather than the cells.
+ * In a headless build (SPL_HEADLESS_MODE) there is no window, and every
+ * member does nothing.
  */
 class LifeGUI {
 public:
@@ -34,7 +52,8 @@ public:
     static void clear();
 
     /**
-     * Draws a black circle for the cell at the specific row and column.
+     * Draws a black circle (or, for cells too small for one, a square) for
+     * the cell at the specific row and column.
      * Rows and columns are specified using zero-based indexing and (0,0) is
      * the upper-left corner.
      * Note that the cell will not immediately appear on the screen; the
@@ -43,10 +62,53 @@ public:
      * fillCell on all living cell locations, and then call repaint once to
      * see all of the changes.
      * If the location given is not in bounds, an error is thrown.
-     * A cell cannot be un-drawn; to make that area white again, call clear().
+     * To un-draw a cell, call clearCell, or clear() to un-draw them all.
      */
     static void fillCell(int row, int col, string color="#000000");
 
+    /**
+     * Draws the cell at the given row and column afresh in the given color,
+     * or un-draws it, leaving the background and grid lines it covered.
+     * As with fillCell, the change appears on the next call to repaint,
+     * which copies only the cells changed since the last repaint into the
+     * buffer it hands the canvas and repaints only the rectangle around
+     * them, so a generation costs little more than the cells that changed
+     * and one blit.
+     * If the location given is not in bounds, an error is thrown.
+     */
+    static void setCell(int row, int col, string color="#000000");
+    static void clearCell(int row, int col);
+
+    /**
+     * Returns true if the window is laid out for a board of the given
+     * size, so that the cells drawn on it are still there; it is not if
+     * resize was last called with another size or the window has changed
+     * size since.  A client that draws only the cells that change needs
+     * to call resize and draw every cell when this returns false.
+     */
+    static bool isSized(int rows, int cols);
+
+    /**
+     * Draws a whole board in the view, resizing the window for it first
+     * if it is not sized for it, with each cell in the color of its state.
+     * Zoomed in, only the cells in view that differ from the board drawn
+     * last are drawn; zoomed out, the view is shaded from a density map of
+     * the board.  As with fillCell, the change appears on the next call to
+     * repaint.  A client should use either this or the cell methods.
+     */
+    static void drawBoard(const CellBoard& board);
+
+    /**
+     * Zooms and moves the view and redraws the board drawBoard drew last
+     * in it; the change appears on the next call to repaint.
+     * A positive zoom makes each cell that many pixels wide, a negative
+     * zoom -n shows 2^n x 2^n cells in each pixel, and a zoom of 0 fits the
+     * whole board in the window, which is how the view starts.  The view
+     * is centered on the given cell as nearly as the edges of the board
+     * allow, and stays put until the board changes size.
+     */
+    static void setView(int zoom, int centerRow, int centerCol);
+
     /**
      * Sets up the state of the GUI and pops up the GUI window on the screen.
      * This needs to be called only once by the client.
@@ -67,11 +129,15 @@ public:
     /**
      * This will erase the graphics window completely, draw a black
      * border around the simulation rectangle which is centered in the
-     * window, and draw light gray grid lines around each cell.
+     * window, and draw light gray grid lines around each cell if the cells
+     * are at least 4 pixels wide.
      * The grid cells will be sized as large as will fit given the
      * grid geometry. Grids with more rows and columns will use smaller
-     * cells. This function can be used at the beginning of a simulation or
-     * between generations to clear the window before drawing the next generation.
+     * cells, and grids with more cells than the window has pixels are
+     * zoomed out to fit. This function can be used at the beginning of a
+     * simulation or between generations to clear the window before drawing
+     * the next generation; when the size has not changed, that only copies
+     * the saved background over the pixel buffer.
      */
     static void resize(int rows, int cols);
 
@@ -110,7 +176,7 @@ private:
     static GWindow* window;
     static const int WINDOW_WIDTH;
     static const int WINDOW_HEIGHT;
-    static int cellDiameter;
+    static int cellDiameter;            // pixels on a side of a cell, 0 if zoomed out
     static int rows;
     static int cols;
     static int upperLeftX;
@@ -118,6 +184,39 @@ private:
     static bool isEnabled;
     static bool isInitialized;
     static bool isToBack;
+    static int boardWidth;              // size of the board area in pixels
+    static int boardHeight;
+    static int canvasWidth;
+    static int canvasHeight;
+    static std::vector<int> pixels;     // the canvas as ARGB, row by row
+    static std::vector<int> background; // the canvas with no cells drawn
+    static std::vector<bool> cellShape; // pixels of a cell that fillCell colors
+    static std::string lastColor;       // the color fillCell converted last
+    static int lastColorARGB;
+    static std::vector<int> dirtyCells; // top-left pixels of cells changed since repaint
+    static bool allDirty;               // every pixel changed since repaint
+    static int zoom;                    // as given to setView, 0 to fit the board
+    static int centerRow;               // the cell the view is centered on
+    static int centerCol;
+    static int cellsPerPixel;           // cells on a side of a pixel, 1 if zoomed in
+    static int viewTop;                 // the top-left cell in view
+    static int viewLeft;
+    static int viewRows;                // rows/columns of cells in view
+    static int viewCols;
+    static CellBoard shown;             // the board drawBoard drew last
+    static DensityMap density;          // the density map of shown
+    static bool isDensityCurrent;       // false if shown changed since density was built
+
+    static void layout();
+    static void drawBackground();
+    static void drawView();
+    static void drawDensity();
+    static void checkCell(int row, int col, const std::string& caller);
+    static int colorToARGB(const std::string& color);
+    static bool isInView(int row, int col);
+    static int cellPixel(int row, int col);
+    static void paintCell(int row, int col, int argb);
+    static void eraseCell(int row, int col);
 };
 
 #endif // _lifegui_h
@@ -0,0 +1,716 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the generation kernels.
+ * See lifekernel.h for the declarations of each function.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "lifekernel.h"
+#include <algorithm>
+#include <vector>
+#include "error.h"
+#include "zobrist.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LIFE_KERNEL_X86 1
+#define LIFE_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+// the helpers built into several kernels, each for its own instruction set
+#if defined(__GNUC__) || defined(__clang__)
+#define LIFE_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define LIFE_ALWAYS_INLINE
+#endif
+
+using namespace std;
+
+/*
+ * All kernels below also OR every word they write into columnHigh[w] and
+ * columnLow[w], and return a word that is nonzero if any cell changed
+ * state, so callers learn what a region holds without reading it again.
+ *
+ * The counting copies of the kernels (COUNTING = true) also add the number
+ * of cells born to births, in a local sum that is added in once at the end,
+ * as births could otherwise alias the rows being written.
+ */
+
+/*
+ * Advances one word of a row, wrapping around the left and right edges
+ * of the board.  This handles the first and last word of every row; the
+ * words in between go through one of the interior kernels below.
+ */
+template <bool COUNTING>
+LIFE_ALWAYS_INLINE
+static inline uint64_t advanceEdgeWord(const uint64_t* const rowsAround[3],
+                                       const uint64_t* high, const uint64_t* low,
+                                       uint64_t* nextHigh, uint64_t* nextLow,
+                                       uint64_t* columnHigh, uint64_t* columnLow,
+                                       int w, int words, int lastBit, uint64_t lastMask,
+                                       uint64_t& births) {
+    uint64_t west[3];
+    uint64_t center[3];
+    uint64_t east[3];
+    for (int i = 0; i < 3; i++) {
+        const uint64_t* row = rowsAround[i];
+        // left-most and right-most columns are neighbors
+        uint64_t previous = w > 0 ? row[w - 1]
+                                  : ((row[words - 1] >> lastBit) & 1) << 63;
+        center[i] = row[w];
+        west[i] = westNeighbors(row[w], previous);
+        if (w < words - 1) {
+            east[i] = eastNeighbors(row[w], row[w + 1]);
+        } else {
+            east[i] = (row[w] >> 1) | ((row[0] & 1) << lastBit);
+        }
+    }
+
+    uint64_t cellHigh = high[w];
+    uint64_t cellLow = low[w];
+    applyRule(west[0], center[0], east[0],
+              west[1], east[1],
+              west[2], center[2], east[2],
+              cellHigh, cellLow);
+
+    // bits past the last column must stay zero
+    uint64_t mask = w == words - 1 ? lastMask : ~uint64_t(0);
+    nextHigh[w] = cellHigh & mask;
+    nextLow[w] = cellLow & mask;
+    columnHigh[w] |= nextHigh[w];
+    columnLow[w] |= nextLow[w];
+    if (COUNTING) {
+        // every X in the next generation was just born
+        births += popcount64(nextHigh[w] & nextLow[w]);
+    }
+    return (nextHigh[w] ^ high[w]) | (nextLow[w] ^ low[w]);
+}
+
+typedef uint64_t (*EdgeKernel)(const uint64_t* const rowsAround[3],
+                               const uint64_t* high, const uint64_t* low,
+                               uint64_t* nextHigh, uint64_t* nextLow,
+                               uint64_t* columnHigh, uint64_t* columnLow,
+                               int w, int words, int lastBit, uint64_t lastMask,
+                               uint64_t& births);
+
+/*
+ * Interior kernels: advance words [wordStart, wordEnd) of a row, where
+ * every word has a real word on both sides (no wrapping, no masking).
+ */
+typedef uint64_t (*InteriorKernel)(const uint64_t* const rowsAround[3],
+                                   const uint64_t* high, const uint64_t* low,
+                                   uint64_t* nextHigh, uint64_t* nextLow,
+                                   uint64_t* columnHigh, uint64_t* columnLow,
+                                   int wordStart, int wordEnd, uint64_t& births);
+
+template <bool COUNTING>
+LIFE_ALWAYS_INLINE
+static inline uint64_t advanceInteriorSwar(const uint64_t* const rowsAround[3],
+                                           const uint64_t* high, const uint64_t* low,
+                                           uint64_t* nextHigh, uint64_t* nextLow,
+                                           uint64_t* columnHigh, uint64_t* columnLow,
+                                           int wordStart, int wordEnd, uint64_t& births) {
+    const uint64_t* above = rowsAround[0];
+    const uint64_t* center = rowsAround[1];
+    const uint64_t* below = rowsAround[2];
+    uint64_t changed = 0;
+    uint64_t born = 0;
+    for (int w = wordStart; w < wordEnd; w++) {
+        uint64_t cellHigh = high[w];
+        uint64_t cellLow = low[w];
+        applyRule(westNeighbors(above[w], above[w - 1]), above[w],
+                  eastNeighbors(above[w], above[w + 1]),
+                  westNeighbors(center[w], center[w - 1]),
+                  eastNeighbors(center[w], center[w + 1]),
+                  westNeighbors(below[w], below[w - 1]), below[w],
+                  eastNeighbors(below[w], below[w + 1]),
+                  cellHigh, cellLow);
+        changed |= (cellHigh ^ high[w]) | (cellLow ^ low[w]);
+        nextHigh[w] = cellHigh;
+        nextLow[w] = cellLow;
+        columnHigh[w] |= cellHigh;
+        columnLow[w] |= cellLow;
+        if (COUNTING) {
+            born += popcount64(cellHigh & cellLow);
+        }
+    }
+    if (COUNTING) {
+        births += born;
+    }
+    return changed;
+}
+
+#ifdef LIFE_KERNEL_X86
+
+/*
+ * The counting portable kernels for CPUs with the popcnt instruction,
+ * which counts the births of a word in one instruction; elsewhere
+ * popcount64 calls a library function.
+ */
+LIFE_TARGET("popcnt")
+static uint64_t advanceEdgeWordPopcnt(const uint64_t* const rowsAround[3],
+                                      const uint64_t* high, const uint64_t* low,
+                                      uint64_t* nextHigh, uint64_t* nextLow,
+                                      uint64_t* columnHigh, uint64_t* columnLow,
+                                      int w, int words, int lastBit, uint64_t lastMask,
+                                      uint64_t& births) {
+    return advanceEdgeWord<true>(rowsAround, high, low, nextHigh, nextLow,
+                                 columnHigh, columnLow, w, words, lastBit, lastMask, births);
+}
+
+LIFE_TARGET("popcnt")
+static uint64_t advanceInteriorSwarPopcnt(const uint64_t* const rowsAround[3],
+                                          const uint64_t* high, const uint64_t* low,
+                                          uint64_t* nextHigh, uint64_t* nextLow,
+                                          uint64_t* columnHigh, uint64_t* columnLow,
+                                          int wordStart, int wordEnd, uint64_t& births) {
+    return advanceInteriorSwar<true>(rowsAround, high, low, nextHigh, nextLow,
+                                     columnHigh, columnLow, wordStart, wordEnd, births);
+}
+
+/*
+ * Adds the number of set bits in each 64-bit lane of v to that lane of
+ * total.  SSE2 has no byte shuffle, so the bits are summed in pairs, then
+ * nibbles, then bytes, and the bytes of each lane are added up with a sum
+ * of absolute differences against zero.
+ */
+LIFE_TARGET("sse2")
+static inline __m128i addLanePopcounts(__m128i total, __m128i v) {
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), _mm_set1_epi8(0x55)));
+    v = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x33)),
+                     _mm_and_si128(_mm_srli_epi64(v, 2), _mm_set1_epi8(0x33)));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), _mm_set1_epi8(0x0f));
+    return _mm_add_epi64(total, _mm_sad_epu8(v, _mm_setzero_si128()));
+}
+
+/*
+ * SSE2 version of the interior kernel: 2 words (128 cells) per instruction.
+ * The rule is the same full-adder network as applyRule.
+ */
+template <bool COUNTING>
+LIFE_TARGET("sse2")
+static uint64_t advanceInteriorSse2(const uint64_t* const rowsAround[3],
+                                    const uint64_t* high, const uint64_t* low,
+                                    uint64_t* nextHigh, uint64_t* nextLow,
+                                    uint64_t* columnHigh, uint64_t* columnLow,
+                                    int wordStart, int wordEnd, uint64_t& births) {
+    __m128i changed = _mm_setzero_si128();
+    __m128i bornCounts = _mm_setzero_si128();
+    int w = wordStart;
+    for (; w + 2 <= wordEnd; w += 2) {
+        __m128i west[3];
+        __m128i center[3];
+        __m128i east[3];
+        for (int i = 0; i < 3; i++) {
+            const uint64_t* row = rowsAround[i];
+            __m128i previous = _mm_loadu_si128((const __m128i*) (row + w - 1));
+            __m128i current = _mm_loadu_si128((const __m128i*) (row + w));
+            __m128i next = _mm_loadu_si128((const __m128i*) (row + w + 1));
+            west[i] = _mm_or_si128(_mm_slli_epi64(current, 1), _mm_srli_epi64(previous, 63));
+            center[i] = current;
+            east[i] = _mm_or_si128(_mm_srli_epi64(current, 1), _mm_slli_epi64(next, 63));
+        }
+
+        __m128i ones1 = _mm_xor_si128(_mm_xor_si128(west[0], center[0]), east[0]);
+        __m128i twos1 = _mm_or_si128(_mm_and_si128(west[0], center[0]),
+                                     _mm_and_si128(east[0], _mm_xor_si128(west[0], center[0])));
+        __m128i ones2 = _mm_xor_si128(_mm_xor_si128(west[1], east[1]), west[2]);
+        __m128i twos2 = _mm_or_si128(_mm_and_si128(west[1], east[1]),
+                                     _mm_and_si128(west[2], _mm_xor_si128(west[1], east[1])));
+        __m128i ones3 = _mm_xor_si128(center[2], east[2]);
+        __m128i twos3 = _mm_and_si128(center[2], east[2]);
+
+        __m128i twos4 = _mm_or_si128(_mm_and_si128(ones1, ones2),
+                                     _mm_and_si128(ones3, _mm_xor_si128(ones1, ones2)));
+        __m128i twosSum = _mm_xor_si128(_mm_xor_si128(twos1, twos2), twos3);
+        __m128i foursA = _mm_or_si128(_mm_and_si128(twos1, twos2),
+                                      _mm_and_si128(twos3, _mm_xor_si128(twos1, twos2)));
+        __m128i twosBit = _mm_xor_si128(twosSum, twos4);
+        __m128i foursB = _mm_and_si128(twosSum, twos4);
+        __m128i twoOrThree = _mm_andnot_si128(_mm_or_si128(foursA, foursB), twosBit);
+
+        __m128i cellHigh = _mm_loadu_si128((const __m128i*) (high + w));
+        __m128i cellLow = _mm_loadu_si128((const __m128i*) (low + w));
+        __m128i born = _mm_andnot_si128(_mm_or_si128(cellHigh, cellLow), twoOrThree);
+        __m128i resultHigh = _mm_or_si128(_mm_and_si128(cellHigh, cellLow), born);
+        __m128i resultLow = _mm_or_si128(_mm_andnot_si128(cellLow, cellHigh), born);
+        _mm_storeu_si128((__m128i*) (nextHigh + w), resultHigh);
+        _mm_storeu_si128((__m128i*) (nextLow + w), resultLow);
+        changed = _mm_or_si128(changed, _mm_or_si128(_mm_xor_si128(resultHigh, cellHigh),
+                                                     _mm_xor_si128(resultLow, cellLow)));
+        __m128i anyHigh = _mm_loadu_si128((const __m128i*) (columnHigh + w));
+        __m128i anyLow = _mm_loadu_si128((const __m128i*) (columnLow + w));
+        _mm_storeu_si128((__m128i*) (columnHigh + w), _mm_or_si128(anyHigh, resultHigh));
+        _mm_storeu_si128((__m128i*) (columnLow + w), _mm_or_si128(anyLow, resultLow));
+        if (COUNTING) {
+            bornCounts = addLanePopcounts(bornCounts, born);
+        }
+    }
+    uint64_t lanes[2];
+    if (COUNTING) {
+        _mm_storeu_si128((__m128i*) lanes, bornCounts);
+        births += lanes[0] + lanes[1];
+    }
+    _mm_storeu_si128((__m128i*) lanes, changed);
+    return lanes[0] | lanes[1]
+            | advanceInteriorSwar<COUNTING>(rowsAround, high, low, nextHigh, nextLow,
+                                            columnHigh, columnLow, w, wordEnd, births);
+}
+
+/*
+ * AVX2 version of the interior kernel: 4 words (256 cells) per instruction.
+ * Every CPU with AVX2 also has popcnt, so the counting copy moves each
+ * word of births out of the vector and counts it with one instruction,
+ * which runs alongside the vector work.
+ */
+template <bool COUNTING>
+LIFE_TARGET("avx2,popcnt")
+static uint64_t advanceInteriorAvx2(const uint64_t* const rowsAround[3],
+                                    const uint64_t* high, const uint64_t* low,
+                                    uint64_t* nextHigh, uint64_t* nextLow,
+                                    uint64_t* columnHigh, uint64_t* columnLow,
+                                    int wordStart, int wordEnd, uint64_t& births) {
+    __m256i changed = _mm256_setzero_si256();
+    uint64_t bornCount = 0;
+    int w = wordStart;
+    for (; w + 4 <= wordEnd; w += 4) {
+        __m256i west[3];
+        __m256i center[3];
+        __m256i east[3];
+        for (int i = 0; i < 3; i++) {
+            const uint64_t* row = rowsAround[i];
+            __m256i previous = _mm256_loadu_si256((const __m256i*) (row + w - 1));
+            __m256i current = _mm256_loadu_si256((const __m256i*) (row + w));
+            __m256i next = _mm256_loadu_si256((const __m256i*) (row + w + 1));
+            west[i] = _mm256_or_si256(_mm256_slli_epi64(current, 1), _mm256_srli_epi64(previous, 63));
+            center[i] = current;
+            east[i] = _mm256_or_si256(_mm256_srli_epi64(current, 1), _mm256_slli_epi64(next, 63));
+        }
+
+        __m256i ones1 = _mm256_xor_si256(_mm256_xor_si256(west[0], center[0]), east[0]);
+        __m256i twos1 = _mm256_or_si256(_mm256_and_si256(west[0], center[0]),
+                                        _mm256_and_si256(east[0], _mm256_xor_si256(west[0], center[0])));
+        __m256i ones2 = _mm256_xor_si256(_mm256_xor_si256(west[1], east[1]), west[2]);
+        __m256i twos2 = _mm256_or_si256(_mm256_and_si256(west[1], east[1]),
+                                        _mm256_and_si256(west[2], _mm256_xor_si256(west[1], east[1])));
+        __m256i ones3 = _mm256_xor_si256(center[2], east[2]);
+        __m256i twos3 = _mm256_and_si256(center[2], east[2]);
+
+        __m256i twos4 = _mm256_or_si256(_mm256_and_si256(ones1, ones2),
+                                        _mm256_and_si256(ones3, _mm256_xor_si256(ones1, ones2)));
+        __m256i twosSum = _mm256_xor_si256(_mm256_xor_si256(twos1, twos2), twos3);
+        __m256i foursA = _mm256_or_si256(_mm256_and_si256(twos1, twos2),
+                                         _mm256_and_si256(twos3, _mm256_xor_si256(twos1, twos2)));
+        __m256i twosBit = _mm256_xor_si256(twosSum, twos4);
+        __m256i foursB = _mm256_and_si256(twosSum, twos4);
+        __m256i twoOrThree = _mm256_andnot_si256(_mm256_or_si256(foursA, foursB), twosBit);
+
+        __m256i cellHigh = _mm256_loadu_si256((const __m256i*) (high + w));
+        __m256i cellLow = _mm256_loadu_si256((const __m256i*) (low + w));
+        __m256i born = _mm256_andnot_si256(_mm256_or_si256(cellHigh, cellLow), twoOrThree);
+        __m256i resultHigh = _mm256_or_si256(_mm256_and_si256(cellHigh, cellLow), born);
+        __m256i resultLow = _mm256_or_si256(_mm256_andnot_si256(cellLow, cellHigh), born);
+        _mm256_storeu_si256((__m256i*) (nextHigh + w), resultHigh);
+        _mm256_storeu_si256((__m256i*) (nextLow + w), resultLow);
+        changed = _mm256_or_si256(changed, _mm256_or_si256(_mm256_xor_si256(resultHigh, cellHigh),
+                                                           _mm256_xor_si256(resultLow, cellLow)));
+        __m256i anyHigh = _mm256_loadu_si256((const __m256i*) (columnHigh + w));
+        __m256i anyLow = _mm256_loadu_si256((const __m256i*) (columnLow + w));
+        _mm256_storeu_si256((__m256i*) (columnHigh + w), _mm256_or_si256(anyHigh, resultHigh));
+        _mm256_storeu_si256((__m256i*) (columnLow + w), _mm256_or_si256(anyLow, resultLow));
+        if (COUNTING) {
+            __m128i lower = _mm256_castsi256_si128(born);
+            __m128i upper = _mm256_extracti128_si256(born, 1);
+            bornCount += popcount64((uint64_t) _mm_cvtsi128_si64(lower))
+                    + popcount64((uint64_t) _mm_extract_epi64(lower, 1))
+                    + popcount64((uint64_t) _mm_cvtsi128_si64(upper))
+                    + popcount64((uint64_t) _mm_extract_epi64(upper, 1));
+        }
+    }
+    if (COUNTING) {
+        births += bornCount;
+    }
+    uint64_t anyChanged = _mm256_testz_si256(changed, changed) ? 0 : 1;
+    return anyChanged
+            | advanceInteriorSwar<COUNTING>(rowsAround, high, low, nextHigh, nextLow,
+                                            columnHigh, columnLow, w, wordEnd, births);
+}
+
+#endif // LIFE_KERNEL_X86
+
+/*
+ * Returns true if the CPU can count the bits of a word in one instruction.
+ */
+static bool hasPopcount() {
+#ifdef LIFE_KERNEL_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif // LIFE_KERNEL_X86
+}
+
+/*
+ * Returns the interior kernel for the given instruction set, the counting
+ * copy if counting is true.
+ */
+static InteriorKernel interiorKernelFor(KernelKind kind, bool counting) {
+#ifdef LIFE_KERNEL_X86
+    if (kind == KERNEL_AVX2) {
+        return counting ? advanceInteriorAvx2<true> : advanceInteriorAvx2<false>;
+    } else if (kind == KERNEL_SSE2) {
+        return counting ? advanceInteriorSse2<true> : advanceInteriorSse2<false>;
+    } else if (counting && hasPopcount()) {
+        return advanceInteriorSwarPopcnt;
+    }
+#endif // LIFE_KERNEL_X86
+    (void) kind;
+    return counting ? advanceInteriorSwar<true> : advanceInteriorSwar<false>;
+}
+
+/*
+ * Returns the counting kernel for the first and last words of a row.
+ */
+static EdgeKernel countingEdgeKernel() {
+#ifdef LIFE_KERNEL_X86
+    if (hasPopcount()) {
+        return advanceEdgeWordPopcnt;
+    }
+#endif // LIFE_KERNEL_X86
+    return advanceEdgeWord<true>;
+}
+
+/*
+ * Picks the widest instruction set this CPU supports.
+ * This runs once, at program startup.
+ */
+static KernelKind detectBestKernel() {
+    if (isKernelSupported(KERNEL_AVX2)) {
+        return KERNEL_AVX2;
+    } else if (isKernelSupported(KERNEL_SSE2)) {
+        return KERNEL_SSE2;
+    } else {
+        return KERNEL_SWAR;
+    }
+}
+
+static KernelKind currentKernel = detectBestKernel();
+static InteriorKernel interiorKernel = interiorKernelFor(currentKernel, false);
+static InteriorKernel countingKernel = interiorKernelFor(currentKernel, true);
+static EdgeKernel countingEdge = countingEdgeKernel();
+
+bool isKernelSupported(KernelKind kind) {
+    switch (kind) {
+    case KERNEL_SWAR:
+        return true;
+#ifdef LIFE_KERNEL_X86
+    case KERNEL_SSE2:
+        __builtin_cpu_init();   // may run before libgcc's own constructor
+        return __builtin_cpu_supports("sse2");
+    case KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif // LIFE_KERNEL_X86
+    default:
+        return false;
+    }
+}
+
+void setKernel(KernelKind kind) {
+    if (!isKernelSupported(kind)) {
+        error("setKernel: " + kernelName(kind) + " is not supported on this CPU");
+    }
+    currentKernel = kind;
+    interiorKernel = interiorKernelFor(kind, false);
+    countingKernel = interiorKernelFor(kind, true);
+}
+
+KernelKind getKernel() {
+    return currentKernel;
+}
+
+string kernelName(KernelKind kind) {
+    switch (kind) {
+    case KERNEL_SWAR:
+        return "swar";
+    case KERNEL_SSE2:
+        return "sse2";
+    case KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
+
+/*
+ * Returns the column of the lowest/highest set bit of a nonzero word.
+ */
+static int lowestBit(uint64_t word) {
+    return popcount64((word & (~word + 1)) - 1);
+}
+
+static int highestBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(word);
+#else
+    int bit = 0;
+    while (word >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+void clearCounts(RegionCounts& counts) {
+    counts.births = 0;
+    counts.top = -1;
+    counts.bottom = -1;
+    counts.left = -1;
+    counts.right = -1;
+}
+
+void addCounts(RegionCounts& total, const RegionCounts& region) {
+    total.births += region.births;
+    if (region.top < 0) {
+        return;
+    }
+    if (total.top < 0) {
+        total.top = region.top;
+        total.bottom = region.bottom;
+        total.left = region.left;
+        total.right = region.right;
+    } else {
+        total.top = std::min(total.top, region.top);
+        total.bottom = std::max(total.bottom, region.bottom);
+        total.left = std::min(total.left, region.left);
+        total.right = std::max(total.right, region.right);
+    }
+}
+
+/*
+ * Returns true if row r of board has any cells in words [wordStart, wordEnd).
+ */
+static bool isRowNonEmpty(const CellBoard& board, int r, int wordStart, int wordEnd) {
+    const uint64_t* high = board.highRow(r);
+    const uint64_t* low = board.lowRow(r);
+    for (int w = wordStart; w < wordEnd; w++) {
+        if (high[w] | low[w]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Adds the counts of a region just computed into dst to counts.  The
+ * columns holding cells come from the words the kernels OR-ed together;
+ * if there are any, the first and last rows holding cells are found by
+ * reading the rows just written in from the top and bottom of the region,
+ * which stops at the first row with a cell, so it is quick unless the
+ * region has many empty rows at its edges.
+ */
+static void countRegion(const CellBoard& dst, int rowStart, int rowEnd, int wordStart, int wordEnd,
+                        const uint64_t* columnHigh, const uint64_t* columnLow,
+                        uint64_t births, RegionCounts& counts) {
+    RegionCounts region;
+    clearCounts(region);
+    region.births = births;
+    for (int w = wordStart; w < wordEnd; w++) {
+        uint64_t any = columnHigh[w] | columnLow[w];
+        if (any) {
+            if (region.left < 0) {
+                region.left = w * CellBoard::CELLS_PER_WORD + lowestBit(any);
+            }
+            region.right = w * CellBoard::CELLS_PER_WORD + highestBit(any);
+        }
+    }
+    if (region.left >= 0) {
+        region.top = rowStart;
+        while (!isRowNonEmpty(dst, region.top, wordStart, wordEnd)) {
+            region.top++;
+        }
+        region.bottom = rowEnd - 1;
+        while (!isRowNonEmpty(dst, region.bottom, wordStart, wordEnd)) {
+            region.bottom--;
+        }
+    }
+    addCounts(counts, region);
+}
+
+bool advanceRows(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd,
+                 vector<uint64_t>& scratch, RegionCounts* counts, uint64_t* hashDelta) {
+    int words = src.wordsPerRow();
+    if (scratch.size() < (size_t) 2 * words) {
+        scratch.resize(2 * words);
+    }
+    std::fill(scratch.begin(), scratch.begin() + 2 * words, 0);
+    dst.discardTileSummary();
+    return advanceRegion(src, dst, rowStart, rowEnd, 0, words, scratch.data(), scratch.data() + words,
+                         counts, hashDelta);
+}
+
+bool advanceRegion(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd,
+                   int wordStart, int wordEnd,
+                   uint64_t* columnHigh, uint64_t* columnLow,
+                   RegionCounts* counts, uint64_t* hashDelta) {
+    int rows = src.numRows();
+    int words = src.wordsPerRow();
+    if (words == 0 || wordStart >= wordEnd) {
+        return false;
+    }
+    int lastBit = (src.numCols() - 1) % CellBoard::CELLS_PER_WORD;
+    uint64_t lastMask = src.lastWordMask();
+    InteriorKernel interior = counts ? countingKernel : interiorKernel;
+    EdgeKernel edge = counts ? countingEdge : advanceEdgeWord<false>;
+
+    // the first and last word of a row wrap around; the rest are interior
+    bool firstWord = wordStart == 0;
+    bool lastWord = wordEnd == words && words > 1;
+    int interiorStart = std::max(wordStart, 1);
+    int interiorEnd = std::min(wordEnd, words - 1);
+
+    uint64_t changed = 0;
+    uint64_t births = 0;
+    uint64_t hashChange = 0;
+    for (int r = rowStart; r < rowEnd; r++) {
+        // top-most and bottom-most rows are neighbors
+        const uint64_t* rowsAround[3] = {
+            src.highRow(r == 0 ? rows - 1 : r - 1),
+            src.highRow(r),
+            src.highRow(r == rows - 1 ? 0 : r + 1)
+        };
+        const uint64_t* high = src.highRow(r);
+        const uint64_t* low = src.lowRow(r);
+        uint64_t* nextHigh = dst.highRow(r);
+        uint64_t* nextLow = dst.lowRow(r);
+
+        uint64_t rowChanged = 0;
+        if (firstWord) {
+            rowChanged |= edge(rowsAround, high, low, nextHigh, nextLow,
+                               columnHigh, columnLow, 0, words, lastBit, lastMask, births);
+        }
+        if (lastWord) {
+            rowChanged |= edge(rowsAround, high, low, nextHigh, nextLow,
+                               columnHigh, columnLow, words - 1, words, lastBit, lastMask, births);
+        }
+        if (interiorStart < interiorEnd) {
+            rowChanged |= interior(rowsAround, high, low, nextHigh, nextLow,
+                                   columnHigh, columnLow, interiorStart, interiorEnd, births);
+        }
+        // the row is still in the cache, and one that did not change
+        // leaves the hash as it is
+        if (hashDelta && rowChanged) {
+            hashChange ^= zobristRowDelta((uint64_t) r * words, high, low, nextHigh, nextLow,
+                                          wordStart, wordEnd);
+        }
+        changed |= rowChanged;
+    }
+    if (counts) {
+        countRegion(dst, rowStart, rowEnd, wordStart, wordEnd, columnHigh, columnLow, births, *counts);
+    }
+    if (hashDelta) {
+        *hashDelta ^= hashChange;
+    }
+    return changed != 0;
+}
+
+void advanceRowsScalar(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd) {
+    int words = src.wordsPerRow();
+    dst.discardTileSummary();
+    for (int r = rowStart; r < rowEnd; r++) {
+        // singleCell updates the grid in place, so start from a copy of the row
+        std::copy(src.highRow(r), src.highRow(r) + words, dst.highRow(r));
+        std::copy(src.lowRow(r), src.lowRow(r) + words, dst.lowRow(r));
+        for (int c = 0; c < src.numCols(); c++) {
+            singleCell(src, dst, r, c);
+        }
+    }
+}
+
+/*
+ * Test if a single cell should be killed, created, or stay the same.
+ * @param copy the copied version of the simulation grid that stays the same
+ * @param grid the simulation grid that is modified
+ * @param r    the row index of the cell to test
+ * @param c    the column index of the cell to test
+ */
+void singleCell(const CellBoard& copy, CellBoard& grid, int r, int c) {
+    int numOfNeighbors = getNumOfNeighbors(r, c, copy);
+    if (numOfNeighbors <= 1 || numOfNeighbors >= 4) {
+        degradeCell(r, c, grid);
+    } else if (numOfNeighbors == 2) {
+        generateCell(r, c, grid);
+    } else if (numOfNeighbors == 3) {
+        generateCell(r, c, grid);
+    }
+}
+
+/*
+ * Create a new cell at (r, c) in the simulation grid.
+ * @param r    the row index of the cell to create
+ * @param c    the column index of the cell to create
+ * @param grid the simulation grid
+ */
+void generateCell(int r, int c, CellBoard& grid) {
+    if (grid.get(r, c) == EMPTY) {
+        grid.set(r, c, ALIVE);
+    } else {
+        degradeCell(r, c, grid);
+    }
+}
+
+/*
+ * Kill the cell at (r, c) in the simulation grid.
+ * @param r    the row index of the cell to create
+ * @param c    the column index of the cell to create
+ * @param grid the simulation grid
+ */
+void degradeCell(int r, int c, CellBoard& grid) {
+    CellState cell = grid.get(r, c);
+    if (cell != EMPTY) { // X -> O -> C -> - is a decrement
+        grid.set(r, c, (CellState) (cell - 1));
+    }
+}
+
+/*
+ * Check if the cell at (r, c) in the simulation grid is occupied or not.
+ * @param r    the row index of the cell to create
+ * @param c    the column index of the cell to create
+ * @param copy the copied version of the simulation grid that stays the same
+ */
+bool isCellOccupied(int r, int c, const CellBoard& copy) {
+    int endRow = copy.numRows() - 1;
+    int endCol = copy.numCols() - 1;
+
+    // wraps around in both dimensions
+    // top-most and bottom-most rows are neighbors
+    if (r == -1) {
+        r = endRow;
+    } else if (r == endRow + 1) {
+        r = 0;
+    }
+
+    // left-most and right-most columns are neighbors
+    if (c == -1) {
+        c = endCol;
+    } else if (c == endCol + 1) {
+        c = 0;
+    }
+
+    // only X and O cells count as neighbors
+    return copy.isOccupied(r, c);
+}
+
+/*
+ * Get the number of neighbors of the cell at (r, c) in the grid.
+ * @param r    the row index of the cell to create
+ * @param c    the column index of the cell to create
+ * @param copy the copied version of the simulation grid that stays the same
+ */
+int getNumOfNeighbors(int r, int c, const CellBoard& copy) {
+    return isCellOccupied(r - 1, c - 1, copy) + isCellOccupied(r - 1, c + 1, copy) +
+            isCellOccupied(r + 1, c - 1, copy) + isCellOccupied(r + 1, c + 1, copy) +
+            isCellOccupied(r - 1, c, copy) + isCellOccupied(r + 1, c, copy) +
+            isCellOccupied(r, c - 1, copy) + isCellOccupied(r, c + 1, copy);
+}
@@ -0,0 +1,195 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the generation kernels that advance a CellBoard by
+ * one generation.
+ * See lifekernel.cpp for the implementation of each function.
+ *
+ * The kernels work on the bit planes of a CellBoard directly: the
+ * occupied (X or O) bits of the eight neighbors of 64 cells are lined up
+ * with shifts, summed with full-adder logic, and the decay rule is then
+ * applied to the high/low planes with plain bitwise operations.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _lifekernel_h
+#define _lifekernel_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "cellboard.h"
+
+/**
+ * Lines up the west (column - 1) neighbor of each cell in a word.
+ * previous is the word just west of word; only its top bit is used.
+ */
+inline std::uint64_t westNeighbors(std::uint64_t word, std::uint64_t previous) {
+    return (word << 1) | (previous >> 63);
+}
+
+/**
+ * Lines up the east (column + 1) neighbor of each cell in a word.
+ * next is the word just east of word; only its bottom bit is used.
+ */
+inline std::uint64_t eastNeighbors(std::uint64_t word, std::uint64_t next) {
+    return (word >> 1) | (next << 63);
+}
+
+/**
+ * Applies the Game of Life decay rule to 64 cells at once.
+ *
+ * The eight neighbor words hold the occupied bit of each cell's
+ * northwest, north, ..., southeast neighbor.  On entry high/low hold the
+ * current state of the cells, and on exit the next state:
+ *  - an empty cell with 2 or 3 occupied neighbors becomes alive (X);
+ *  - every other cell ages one step, X -> O -> C -> -.
+ * This is the same transition as singleCell/generateCell/degradeCell.
+ */
+inline void applyRule(std::uint64_t nw, std::uint64_t n, std::uint64_t ne,
+                      std::uint64_t w, std::uint64_t e,
+                      std::uint64_t sw, std::uint64_t s, std::uint64_t se,
+                      std::uint64_t& high, std::uint64_t& low) {
+    // count the neighbors bit-serially: three full adders on the inputs ...
+    std::uint64_t ones1 = nw ^ n ^ ne;
+    std::uint64_t twos1 = (nw & n) | (ne & (nw ^ n));
+    std::uint64_t ones2 = w ^ e ^ sw;
+    std::uint64_t twos2 = (w & e) | (sw & (w ^ e));
+    std::uint64_t ones3 = s ^ se;
+    std::uint64_t twos3 = s & se;
+
+    // ... then combine the partial sums by weight
+    std::uint64_t twos4 = (ones1 & ones2) | (ones3 & (ones1 ^ ones2));
+    std::uint64_t twosSum = twos1 ^ twos2 ^ twos3;
+    std::uint64_t foursA = (twos1 & twos2) | (twos3 & (twos1 ^ twos2));
+    std::uint64_t twosBit = twosSum ^ twos4;
+    std::uint64_t foursB = twosSum & twos4;
+
+    // 2 or 3 neighbors: the twos bit is set and nothing of weight 4 or more
+    std::uint64_t twoOrThree = twosBit & ~(foursA | foursB);
+
+    std::uint64_t born = ~(high | low) & twoOrThree;
+    std::uint64_t nextHigh = (high & low) | born;
+    std::uint64_t nextLow = (high & ~low) | born;
+    high = nextHigh;
+    low = nextLow;
+}
+
+/**
+ * The instruction sets the bit-parallel kernel can run with.
+ * The widest one the CPU supports is picked at startup.
+ */
+enum KernelKind {
+    KERNEL_SWAR,    // portable, one 64-bit word (64 cells) at a time
+    KERNEL_SSE2,    // 128-bit vectors, 128 cells per instruction
+    KERNEL_AVX2     // 256-bit vectors, 256 cells per instruction
+};
+
+/**
+ * Returns true if the given kernel can run on this CPU (checked via CPUID).
+ */
+bool isKernelSupported(KernelKind kind);
+
+/**
+ * Selects the kernel used by advanceRows.
+ * If the kernel is not supported on this CPU, an error is thrown.
+ */
+void setKernel(KernelKind kind);
+
+/**
+ * Returns the kernel currently used by advanceRows.
+ */
+KernelKind getKernel();
+
+/**
+ * Returns a short lowercase name for the kernel, such as "avx2".
+ */
+std::string kernelName(KernelKind kind);
+
+/**
+ * What the kernels count about the cells of a generation as they compute
+ * them, for the telemetry log.  Only births need counting: under the
+ * decay rule the cells that become X are exactly the births, every other
+ * cell ages one step, so the rest of a generation's census follows from
+ * the one before (see TelemetryLog).
+ */
+struct RegionCounts {
+    std::uint64_t births;   // empty cells that became X
+    int top;                // first and last rows and columns holding any
+    int bottom;             //   cells in the generation computed, or -1
+    int left;               //   for all four if it has none
+    int right;
+};
+
+/**
+ * Empties counts, ready to add regions to.
+ */
+void clearCounts(RegionCounts& counts);
+
+/**
+ * Adds the counts of another region of the same generation to total.
+ */
+void addCounts(RegionCounts& total, const RegionCounts& region);
+
+/**
+ * Computes rows [rowStart, rowEnd) of the generation after src into dst
+ * with the bit-parallel kernel.  dst must have the same dimensions as src
+ * and must not be the same board.  Rows and columns wrap around, exactly
+ * like isCellOccupied.  Discards dst's tile summary.
+ * Returns true if any of the cells computed differs from src.
+ * scratch holds the column buffers the kernels write (see advanceRegion)
+ * and is grown to 2 * src.wordsPerRow() words if it is smaller, so a
+ * caller that keeps it from one generation to the next allocates nothing.
+ * If counts or hashDelta are given, the cells computed are counted into
+ * counts and their change of hash XORed into hashDelta, as in
+ * advanceRegion.
+ */
+bool advanceRows(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd,
+                 std::vector<std::uint64_t>& scratch,
+                 RegionCounts* counts = nullptr, std::uint64_t* hashDelta = nullptr);
+
+/**
+ * Same as advanceRows, but only for the words [wordStart, wordEnd) of each
+ * row, i.e. columns 64 * wordStart up to 64 * wordEnd.  Used to advance
+ * one rectangular tile of the board at a time.
+ * Unlike advanceRows this leaves dst's tile summary alone, so several
+ * threads can advance different regions of the same dst; the caller is
+ * responsible for discarding or replacing the summary.
+ *
+ * Every word written to dst is also OR-ed into columnHigh[w] and
+ * columnLow[w] (indexed by the word's position in the row, like the row
+ * itself), which tells the caller which columns of the region have X/O
+ * cells and which have any cells at all; the caller owns both buffers.
+ *
+ * If counts is given, the births and the extent of the cells computed are
+ * added to it; the columns are read back from columnHigh and columnLow,
+ * so those must start out zero for the words of the region.  This runs a
+ * counting copy of the kernel, which pays a few instructions per word for
+ * a population count; without counts the kernel does no counting at all.
+ *
+ * If hashDelta is given, the change the region makes to the board's
+ * Zobrist hash (see zobristRowDelta) is XORed into it, rehashing just the
+ * words of each changed row that changed, while the row is still cached.
+ */
+bool advanceRegion(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd,
+                   int wordStart, int wordEnd,
+                   std::uint64_t* columnHigh, std::uint64_t* columnLow,
+                   RegionCounts* counts = nullptr, std::uint64_t* hashDelta = nullptr);
+
+/**
+ * Same as advanceRows, but one cell at a time using singleCell.
+ * This is the reference the faster kernels are checked against.
+ */
+void advanceRowsScalar(const CellBoard& src, CellBoard& dst, int rowStart, int rowEnd);
+
+/*
+ * Per-cell form of the rule, used by advanceRowsScalar.
+ * See lifekernel.cpp for a description of each function.
+ */
+void singleCell(const CellBoard& copy, CellBoard& grid, int r, int c);
+bool isCellOccupied(int r, int c, const CellBoard& copy);
+int getNumOfNeighbors(int r, int c, const CellBoard& copy);
+void degradeCell(int r, int c, CellBoard& grid);
+void generateCell(int r, int c, CellBoard& grid);
+
+#endif // _lifekernel_h
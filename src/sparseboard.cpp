@@ -0,0 +1,266 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the SparseBoard class.
+ * See sparseboard.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "sparseboard.h"
+#include <unordered_set>
+#include "error.h"
+#include "lifekernel.h"
+
+using namespace std;
+
+/*
+ * Splits a row or column into the index of its chunk and its position in
+ * that chunk, rounding towards minus infinity for negative numbers.
+ */
+static int64_t chunkIndex(int64_t n) {
+    return n >= 0 ? n / SparseBoard::CHUNK_SIZE : -((-n - 1) / SparseBoard::CHUNK_SIZE) - 1;
+}
+
+static int chunkOffset(int64_t n) {
+    return (int) (n - chunkIndex(n) * SparseBoard::CHUNK_SIZE);
+}
+
+SparseBoard::SparseBoard() {
+    // empty
+}
+
+void SparseBoard::clear() {
+    chunks.clear();
+}
+
+void SparseBoard::load(const CellBoard& board, int64_t top, int64_t left) {
+    clear();
+    for (int r = 0; r < board.numRows(); r++) {
+        for (int c = 0; c < board.numCols(); c++) {
+            CellState state = board.get(r, c);
+            if (state != EMPTY) {
+                set(top + r, left + c, state);
+            }
+        }
+    }
+}
+
+CellState SparseBoard::get(int64_t r, int64_t c) const {
+    const Chunk* chunk = find(chunkIndex(r), chunkIndex(c));
+    if (!chunk) {
+        return EMPTY;
+    }
+    int row = chunkOffset(r);
+    int bit = chunkOffset(c);
+    int high = (chunk->high[row] >> bit) & 1;
+    int low = (chunk->low[row] >> bit) & 1;
+    return (CellState) (high << 1 | low);
+}
+
+void SparseBoard::set(int64_t r, int64_t c, CellState state) {
+    ChunkKey key = {chunkIndex(r), chunkIndex(c)};
+    unordered_map<ChunkKey, Chunk, ChunkKeyHash>::iterator found = chunks.find(key);
+    if (found == chunks.end()) {
+        if (state == EMPTY) {
+            return;
+        }
+        Chunk empty = {{0}, {0}};
+        found = chunks.insert(make_pair(key, empty)).first;
+    }
+    Chunk& chunk = found->second;
+    int row = chunkOffset(r);
+    uint64_t mask = uint64_t(1) << chunkOffset(c);
+    chunk.high[row] = (state & 2) ? chunk.high[row] | mask : chunk.high[row] & ~mask;
+    chunk.low[row] = (state & 1) ? chunk.low[row] | mask : chunk.low[row] & ~mask;
+    if (state == EMPTY) {
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            if (chunk.high[i] | chunk.low[i]) {
+                return;
+            }
+        }
+        chunks.erase(found);
+    }
+}
+
+void SparseBoard::advance() {
+    // a chunk can change if it has cells, or if a neighbor chunk has an
+    // X or O on the edge they share
+    unordered_set<ChunkKey, ChunkKeyHash> candidates;
+    for (const pair<const ChunkKey, Chunk>& entry : chunks) {
+        const Chunk& chunk = entry.second;
+        uint64_t westEdge = 0;
+        uint64_t eastEdge = 0;
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            westEdge |= chunk.high[i] & 1;
+            eastEdge |= chunk.high[i] >> 63;
+        }
+        bool north = chunk.high[0] != 0;
+        bool south = chunk.high[CHUNK_SIZE - 1] != 0;
+        bool west = westEdge != 0;
+        bool east = eastEdge != 0;
+        candidates.insert(entry.first);
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                bool touches = (dr != -1 || north) && (dr != 1 || south)
+                        && (dc != -1 || west) && (dc != 1 || east);
+                if ((dr != 0 || dc != 0) && touches) {
+                    ChunkKey key = {entry.first.row + dr, entry.first.col + dc};
+                    candidates.insert(key);
+                }
+            }
+        }
+    }
+
+    unordered_map<ChunkKey, Chunk, ChunkKeyHash> next;
+    next.reserve(candidates.size());
+    Chunk chunk;
+    for (const ChunkKey& key : candidates) {
+        if (advanceChunk(key.row, key.col, chunk)) {
+            next.insert(make_pair(key, chunk));
+        }
+    }
+    chunks.swap(next);
+}
+
+uint64_t SparseBoard::count(CellState state) const {
+    if (state == EMPTY) {
+        error("SparseBoard::count the plane has infinitely many empty cells");
+    }
+    uint64_t total = 0;
+    for (const pair<const ChunkKey, Chunk>& entry : chunks) {
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            uint64_t high = (state & 2) ? entry.second.high[i] : ~entry.second.high[i];
+            uint64_t low = (state & 1) ? entry.second.low[i] : ~entry.second.low[i];
+            total += popcount64(high & low);
+        }
+    }
+    return total;
+}
+
+bool SparseBoard::isEmpty() const {
+    return chunks.empty();
+}
+
+int SparseBoard::numChunks() const {
+    return (int) chunks.size();
+}
+
+/*
+ * Adds a chunk's row word to a board row whose word j starts colShift
+ * columns into the chunk, so that its cells land in words j and j - 1.
+ */
+static void placeWord(uint64_t* row, int words, int j, int colShift, uint64_t word) {
+    if (j < words) {
+        row[j] |= word >> colShift;
+    }
+    if (colShift > 0 && j > 0) {
+        row[j - 1] |= word << (CellBoard::CELLS_PER_WORD - colShift);
+    }
+}
+
+void SparseBoard::toBoard(CellBoard& board, int64_t top, int64_t left) const {
+    board.clear();
+    // the window is copied a chunk row at a time, a word at a time, looking
+    // up each chunk it overlaps once rather than each of its cells
+    int rowShift = chunkOffset(top);
+    int colShift = chunkOffset(left);
+    int chunkRows = (rowShift + board.numRows() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunkCols = (colShift + board.numCols() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int words = board.wordsPerRow();
+    for (int i = 0; i < chunkRows && !chunks.empty(); i++) {
+        for (int j = 0; j < chunkCols; j++) {
+            const Chunk* chunk = find(chunkIndex(top) + i, chunkIndex(left) + j);
+            if (!chunk) {
+                continue;
+            }
+            for (int row = 0; row < CHUNK_SIZE; row++) {
+                int r = i * CHUNK_SIZE + row - rowShift;
+                if (r >= 0 && r < board.numRows()) {
+                    placeWord(board.highRow(r), words, j, colShift, chunk->high[row]);
+                    placeWord(board.lowRow(r), words, j, colShift, chunk->low[row]);
+                }
+            }
+        }
+    }
+    // cells of the last chunk column can fall past the board's last column
+    uint64_t mask = board.lastWordMask();
+    for (int r = 0; r < board.numRows() && words > 0; r++) {
+        board.highRow(r)[words - 1] &= mask;
+        board.lowRow(r)[words - 1] &= mask;
+    }
+}
+
+bool SparseBoard::ChunkKey::operator ==(const ChunkKey& other) const {
+    return row == other.row && col == other.col;
+}
+
+/*
+ * Hash of a chunk's coordinates, mixing all 64 bits of both so that chunks
+ * any distance apart get unrelated hashes.
+ */
+size_t SparseBoard::ChunkKeyHash::operator ()(const ChunkKey& key) const {
+    uint64_t hash = (uint64_t) key.row * 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (hash >> 32) ^ (uint64_t) key.col) * 0xC2B2AE3D27D4EB4FULL;
+    return (size_t) (hash ^ (hash >> 29));
+}
+
+/*
+ * Returns the chunk at the given chunk coordinates, or nullptr if it has
+ * no cells.
+ */
+const SparseBoard::Chunk* SparseBoard::find(int64_t chunkRow, int64_t chunkCol) const {
+    ChunkKey key = {chunkRow, chunkCol};
+    unordered_map<ChunkKey, Chunk, ChunkKeyHash>::const_iterator found = chunks.find(key);
+    return found == chunks.end() ? nullptr : &found->second;
+}
+
+/*
+ * Computes the next generation of one chunk into next with the same rule
+ * as the CellBoard kernels, reading the edges of the eight chunks around
+ * it.  Returns false if the chunk ends up empty.
+ */
+bool SparseBoard::advanceChunk(int64_t chunkRow, int64_t chunkCol, Chunk& next) const {
+    static const Chunk EMPTY_CHUNK = {{0}, {0}};
+    const Chunk* around[3][3];
+    for (int dr = 0; dr < 3; dr++) {
+        for (int dc = 0; dc < 3; dc++) {
+            const Chunk* chunk = find(chunkRow + dr - 1, chunkCol + dc - 1);
+            around[dr][dc] = chunk ? chunk : &EMPTY_CHUNK;
+        }
+    }
+    const Chunk& centre = *around[1][1];
+
+    uint64_t any = 0;
+    for (int r = 0; r < CHUNK_SIZE; r++) {
+        // the occupied bits of the rows above, at, and below r, with the
+        // words just west and east of them
+        uint64_t rowWords[3][3];
+        for (int i = 0; i < 3; i++) {
+            int row = r + i - 1;
+            int band = 1;
+            if (row < 0) {
+                row += CHUNK_SIZE;
+                band = 0;
+            } else if (row >= CHUNK_SIZE) {
+                row -= CHUNK_SIZE;
+                band = 2;
+            }
+            for (int dc = 0; dc < 3; dc++) {
+                rowWords[i][dc] = around[band][dc]->high[row];
+            }
+        }
+        uint64_t high = centre.high[r];
+        uint64_t low = centre.low[r];
+        applyRule(westNeighbors(rowWords[0][1], rowWords[0][0]), rowWords[0][1],
+                  eastNeighbors(rowWords[0][1], rowWords[0][2]),
+                  westNeighbors(rowWords[1][1], rowWords[1][0]),
+                  eastNeighbors(rowWords[1][1], rowWords[1][2]),
+                  westNeighbors(rowWords[2][1], rowWords[2][0]), rowWords[2][1],
+                  eastNeighbors(rowWords[2][1], rowWords[2][2]),
+                  high, low);
+        next.high[r] = high;
+        next.low[r] = low;
+        any |= high | low;
+    }
+    return any != 0;
+}
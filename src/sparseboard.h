@@ -0,0 +1,103 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the SparseBoard class, an unbounded plane of cells.
+ * See sparseboard.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _sparseboard_h
+#define _sparseboard_h
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "cellboard.h"
+
+/**
+ * The SparseBoard class is an unbounded plane of cells with no wrapping
+ * edges.  It is stored as a hash map of 64x64 chunks, each held as two
+ * bit planes like a CellBoard; a chunk is only allocated while it has a
+ * non-empty cell in it, so memory grows with the colony, not with the
+ * area it has spread over.  Rows and columns can be any 64-bit number,
+ * including negative ones.
+ */
+class SparseBoard {
+public:
+    /**
+     * Number of rows and columns in a chunk.
+     */
+    static const int CHUNK_SIZE = 64;
+
+    /**
+     * Creates an empty plane.
+     */
+    SparseBoard();
+
+    /**
+     * Sets every cell to EMPTY.
+     */
+    void clear();
+
+    /**
+     * Replaces the contents of the plane with a copy of board, with the
+     * board's top-left cell at (top, left).
+     */
+    void load(const CellBoard& board, std::int64_t top = 0, std::int64_t left = 0);
+
+    /**
+     * Returns/sets the state of the cell at (r, c).
+     */
+    CellState get(std::int64_t r, std::int64_t c) const;
+    void set(std::int64_t r, std::int64_t c, CellState state);
+
+    /**
+     * Computes the next generation.  Cells beyond the edges of the colony
+     * are empty rather than wrapping around to the other side.
+     */
+    void advance();
+
+    /**
+     * Returns the number of cells in the given state; EMPTY is not allowed.
+     */
+    std::uint64_t count(CellState state) const;
+
+    /**
+     * Returns true if every cell of the plane is empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     * Returns the number of chunks in use.
+     */
+    int numChunks() const;
+
+    /**
+     * Copies the window of the plane whose top-left cell is (top, left)
+     * into board, keeping the board's size.
+     */
+    void toBoard(CellBoard& board, std::int64_t top, std::int64_t left) const;
+
+private:
+    struct Chunk {
+        std::uint64_t high[CHUNK_SIZE];
+        std::uint64_t low[CHUNK_SIZE];
+    };
+
+    struct ChunkKey {
+        std::int64_t row;       // the chunk's rows are 64 * row to 64 * row + 63
+        std::int64_t col;
+        bool operator ==(const ChunkKey& other) const;
+    };
+
+    struct ChunkKeyHash {
+        std::size_t operator ()(const ChunkKey& key) const;
+    };
+
+    const Chunk* find(std::int64_t chunkRow, std::int64_t chunkCol) const;
+    bool advanceChunk(std::int64_t chunkRow, std::int64_t chunkCol, Chunk& next) const;
+
+    std::unordered_map<ChunkKey, Chunk, ChunkKeyHash> chunks;
+};
+
+#endif // _sparseboard_h
@@ -0,0 +1,129 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the TelemetryLog class.
+ * See telemetry.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "telemetry.h"
+#include <cstring>
+#include <vector>
+#include "error.h"
+
+using namespace std;
+
+static const char TELEMETRY_MAGIC[8] = {'L', 'I', 'F', 'E', 'T', 'E', 'L', 'E'};
+static const uint32_t TELEMETRY_VERSION = 1;
+static const uint32_t TELEMETRY_RECORD_BYTES = 72;
+
+static_assert(sizeof(GenerationRecord) == TELEMETRY_RECORD_BYTES,
+              "GenerationRecord must have no padding, as it is written as it is");
+
+TelemetryLog::TelemetryLog(const string& filename, TelemetryFormat format)
+        : filename(filename),
+          format(format),
+          file(filename.c_str(), ios::binary | ios::trunc),
+          recordsWritten(0) {
+    if (!file) {
+        error("cannot write " + filename);
+    }
+    memset(&current, 0, sizeof(current));
+    if (format == TELEMETRY_CSV) {
+        file << "generation,alive,dying,decaying,births,deaths,changed,top,left,bottom,right\n";
+    } else {
+        uint32_t header[2] = {TELEMETRY_VERSION, TELEMETRY_RECORD_BYTES};
+        file.write(TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+        file.write((const char*) header, sizeof(header));
+    }
+}
+
+void TelemetryLog::start(const CellBoard& board, long long generation) {
+    GenerationRecord record;
+    memset(&record, 0, sizeof(record));
+    record.generation = generation;
+    record.top = record.left = record.bottom = record.right = -1;
+
+    // one pass over the board, counting each state with the same bit
+    // tricks as CellBoard::count and OR-ing the rows together for the columns
+    int words = board.wordsPerRow();
+    vector<uint64_t> columns(words, 0);
+    for (int r = 0; r < board.numRows(); r++) {
+        const uint64_t* high = board.highRow(r);
+        const uint64_t* low = board.lowRow(r);
+        uint64_t any = 0;
+        for (int w = 0; w < words; w++) {
+            record.alive += popcount64(high[w] & low[w]);
+            record.dying += popcount64(high[w] & ~low[w]);
+            record.decaying += popcount64(~high[w] & low[w]);
+            columns[w] |= high[w] | low[w];
+            any |= high[w] | low[w];
+        }
+        if (any) {
+            if (record.top < 0) {
+                record.top = r;
+            }
+            record.bottom = r;
+        }
+    }
+    for (int c = 0; c < board.numCols() && record.top >= 0; c++) {
+        if ((columns[c / CellBoard::CELLS_PER_WORD] >> (c % CellBoard::CELLS_PER_WORD)) & 1) {
+            if (record.left < 0) {
+                record.left = c;
+            }
+            record.right = c;
+        }
+    }
+    current = record;
+    write(current);
+}
+
+void TelemetryLog::record(const RegionCounts& counts) {
+    GenerationRecord next;
+    next.generation = current.generation + 1;
+    next.alive = counts.births;
+    next.dying = current.alive;
+    next.decaying = current.dying;
+    next.births = counts.births;
+    next.deaths = current.decaying;
+    next.changed = counts.births + current.alive + current.dying + current.decaying;
+    next.top = counts.top;
+    next.left = counts.left;
+    next.bottom = counts.bottom;
+    next.right = counts.right;
+    current = next;
+    write(current);
+}
+
+void TelemetryLog::finish() {
+    if (file.is_open()) {
+        file.close();
+    }
+    if (!file) {
+        error("cannot write " + filename);
+    }
+}
+
+const GenerationRecord& TelemetryLog::last() const {
+    return current;
+}
+
+long long TelemetryLog::getRecordsWritten() const {
+    return recordsWritten;
+}
+
+/*
+ * Appends one record to the file; the stream buffers them, so this costs
+ * no system call.
+ */
+void TelemetryLog::write(const GenerationRecord& record) {
+    if (format == TELEMETRY_CSV) {
+        file << record.generation << ',' << record.alive << ',' << record.dying << ','
+             << record.decaying << ',' << record.births << ',' << record.deaths << ','
+             << record.changed << ',' << record.top << ',' << record.left << ','
+             << record.bottom << ',' << record.right << '\n';
+    } else {
+        file.write((const char*) &record, sizeof(record));
+    }
+    recordsWritten++;
+}
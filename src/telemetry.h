@@ -0,0 +1,114 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the telemetry log, which records how many cells of
+ * each kind a run has at every generation.
+ * See telemetry.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _telemetry_h
+#define _telemetry_h
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "cellboard.h"
+#include "lifekernel.h"
+
+/**
+ * The census of one generation, a line of the telemetry log.
+ */
+struct GenerationRecord {
+    long long generation;
+    std::uint64_t alive;        // X cells
+    std::uint64_t dying;        // O cells
+    std::uint64_t decaying;     // C cells
+    std::uint64_t births;       // cells that went from - to X since the generation before
+    std::uint64_t deaths;       // cells that went from C to -
+    std::uint64_t changed;      // cells whose state changed
+    std::int32_t top;           // the first and last rows and columns holding
+    std::int32_t left;          //   any cells, or -1 for all four if there
+    std::int32_t bottom;        //   are none
+    std::int32_t right;
+};
+
+/**
+ * The file formats of a telemetry log.
+ */
+enum TelemetryFormat {
+    TELEMETRY_CSV,
+    TELEMETRY_BINARY
+};
+
+/**
+ * The TelemetryLog class writes a GenerationRecord for every generation of
+ * a run to a file, as it goes.
+ *
+ * Nothing is counted by reading the board: the kernels count the births
+ * and the extent of each generation while computing it (see RegionCounts),
+ * and the rest follows from the generation before, because under the
+ * decay rule every cell that is not born ages one step:
+ *   X = births, O = the X before, C = the O before, deaths = the C before,
+ *   changed = births + every cell the generation before had.
+ * Only the first generation is counted from the board.  So the log costs a
+ * population count per word of the kernel and a record per generation.
+ *
+ * The CSV format has a header line naming the columns, then a line per
+ * generation.  The binary format has a 16-byte header:
+ *   bytes 0-7    the magic string "LIFETELE"
+ *   bytes 8-11   the format version, 1
+ *   bytes 12-15  the size of a record, 72
+ * then a record per generation: the generation and the six counts as
+ * 64-bit numbers, then top, left, bottom and right as 32-bit ones, in the
+ * order of GenerationRecord, little-endian like board snapshots.
+ */
+class TelemetryLog {
+public:
+    /**
+     * Opens a log writing to the named file in the given format.
+     * If the file cannot be created, an error is thrown.
+     */
+    TelemetryLog(const std::string& filename, TelemetryFormat format);
+
+    /**
+     * Logs board, the first generation of a run, counting it cell by cell.
+     */
+    void start(const CellBoard& board, long long generation);
+
+    /**
+     * Logs the generation after the one logged last, from the kernels'
+     * counts of it.
+     */
+    void record(const RegionCounts& counts);
+
+    /**
+     * Writes out anything still buffered and closes the file.
+     * If the file could not be written, an error is thrown.
+     */
+    void finish();
+
+    /**
+     * Returns the record of the generation logged last.
+     */
+    const GenerationRecord& last() const;
+
+    /**
+     * Returns the number of generations logged so far.
+     */
+    long long getRecordsWritten() const;
+
+private:
+    void write(const GenerationRecord& record);
+
+    std::string filename;
+    TelemetryFormat format;
+    std::ofstream file;
+    GenerationRecord current;
+    long long recordsWritten;
+
+    TelemetryLog(const TelemetryLog&);              // not copyable
+    TelemetryLog& operator =(const TelemetryLog&);
+};
+
+#endif // _telemetry_h
@@ -0,0 +1,96 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the ThreadPool class.
+ * See threadpool.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "threadpool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads)
+        : job(nullptr),
+          jobTasks(0),
+          nextTask(0),
+          busyWorkers(0),
+          round(0),
+          stopping(false) {
+    for (int i = 1; i < threads; i++) {
+        workers.push_back(thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return (int) workers.size() + 1;
+}
+
+void ThreadPool::run(int tasks, const function<void(int)>& task) {
+    if (workers.empty() || tasks <= 1) {
+        for (int i = 0; i < tasks; i++) {
+            task(i);
+        }
+        return;
+    }
+    {
+        lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobTasks = tasks;
+        nextTask = 0;
+        busyWorkers = (int) workers.size();
+        round++;
+    }
+    workReady.notify_all();
+
+    // the calling thread works too instead of just waiting
+    runTasks();
+
+    unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+/*
+ * Take tasks from the current batch until there are none left.
+ */
+void ThreadPool::runTasks() {
+    for (int i = nextTask++; i < jobTasks; i = nextTask++) {
+        (*job)(i);
+    }
+}
+
+/*
+ * Body of each worker thread: sleep until a new batch is posted, help run
+ * it, report back, and repeat until the pool is destroyed.
+ */
+void ThreadPool::workerLoop() {
+    long lastRound = 0;
+    while (true) {
+        {
+            unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this, lastRound] { return stopping || round != lastRound; });
+            if (stopping) {
+                return;
+            }
+            lastRound = round;
+        }
+        runTasks();
+        {
+            lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        workDone.notify_one();
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares ThreadPool, a fixed set of worker threads that is
+ * created once and reused for every generation.
+ * See threadpool.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _threadpool_h
+#define _threadpool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A ThreadPool runs batches of numbered tasks on persistent worker threads.
+ * Each call to run is a barrier: it returns only after every task in the
+ * batch has finished, so consecutive generations never overlap.
+ */
+class ThreadPool {
+public:
+    /**
+     * Starts a pool that runs tasks on the given number of threads.
+     * The thread that calls run counts as one of them, so threads - 1
+     * workers are created.
+     */
+    explicit ThreadPool(int threads);
+
+    /**
+     * Stops and joins all worker threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * Returns the number of threads that run tasks, including the caller.
+     */
+    int size() const;
+
+    /**
+     * Calls task(0), task(1), ..., task(tasks - 1), spread over the pool's
+     * threads, and waits until all of them have returned.
+     * Tasks are handed out in order but may finish in any order, so they
+     * must not depend on one another.
+     */
+    void run(int tasks, const std::function<void(int)>& task);
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    const std::function<void(int)>* job;
+    int jobTasks;
+    std::atomic<int> nextTask;
+    int busyWorkers;
+    long round;
+    bool stopping;
+
+    ThreadPool(const ThreadPool&);              // not copyable
+    ThreadPool& operator =(const ThreadPool&);
+};
+
+#endif // _threadpool_h
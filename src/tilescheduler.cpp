@@ -0,0 +1,289 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the TileScheduler class.
+ * See tilescheduler.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "tilescheduler.h"
+#include <algorithm>
+#include <chrono>
+#include "lifekernel.h"
+
+using namespace std;
+
+/*
+ * Milliseconds elapsed since the given time point.
+ */
+static double millisSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+TileScheduler::TileScheduler()
+        : rows(0),
+          words(0),
+          tileRows(0),
+          tileCols(0),
+          taskCols(0),
+          threads(1),
+          source(nullptr),
+          target(nullptr),
+          counting(false),
+          hashing(false) {
+    stats = TileStats();
+}
+
+bool TileScheduler::advance(ThreadPool& pool, int maxThreads, const CellBoard& src, CellBoard& dst,
+                            RegionCounts* counts, uint64_t* hashDelta) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    stats = TileStats();
+    maxThreads = std::max(1, std::min(maxThreads, pool.size()));
+    resize(src, maxThreads);
+
+    // find which tiles hold anything: free if src was computed by us,
+    // otherwise scan it, one band of tile rows per thread
+    const vector<unsigned char>* srcFlags = &src.tileSummary();
+    if (!src.hasTileSummary()) {
+        scannedFlags.assign(tileRows * tileCols, 0);
+        int bands = std::min(maxThreads, tileRows);
+        pool.run(bands, [this, &src, bands](int band) {
+            scanTiles(src, tileRows * band / bands, tileRows * (band + 1) / bands);
+        });
+        srcFlags = &scannedFlags;
+    }
+    bool dstKnown = dst.hasTileSummary();
+    if (dstKnown) {
+        oldDstFlags = dst.tileSummary();
+    }
+    dst.discardTileSummary();
+
+    // mark the active tiles of each task; inactive tiles only need
+    // clearing if dst has something there
+    tasks.clear();
+    nextFlags.assign(tileRows * tileCols, 0);
+    activeMask.assign(tileRows * taskCols, 0);
+    clearMask.assign(tileRows * taskCols, 0);
+    int active = 0;
+    for (int tr = 0; tr < tileRows; tr++) {
+        for (int tc = 0; tc < tileCols; tc++) {
+            int tile = tr * tileCols + tc;
+            int task = tr * taskCols + tc / TASK_TILES;
+            uint32_t bit = uint32_t(1) << (tc % TASK_TILES);
+            if (isActive(*srcFlags, tr, tc)) {
+                activeMask[task] |= bit;
+                active++;
+            } else if (!dstKnown || (oldDstFlags[tile] & TILE_NON_EMPTY)) {
+                clearMask[task] |= bit;
+            }
+        }
+    }
+    for (int task = 0; task < tileRows * taskCols; task++) {
+        if (activeMask[task] | clearMask[task]) {
+            tasks.push_back(task);
+        }
+    }
+
+    // deal the tasks out in row-major runs, at least one per thread
+    threads = std::max(1, std::min(maxThreads, (int) tasks.size()));
+    for (int worker = 0; worker < threads; worker++) {
+        deques[worker]->clear();
+        size_t first = tasks.size() * worker / threads;
+        size_t last = tasks.size() * (worker + 1) / threads;
+        for (size_t i = first; i < last; i++) {
+            deques[worker]->push(tasks[i]);
+        }
+        workerSteals[worker] = 0;
+        workerBusyMs[worker] = 0;
+        workerChanged[worker] = false;
+        clearCounts(workerCounts[worker]);
+        workerHashes[worker] = 0;
+    }
+    counting = counts != nullptr;
+    hashing = hashDelta != nullptr;
+
+    // the workers find the boards through this, so the job holds nothing
+    // but this pointer and std::function needs no memory for it
+    source = &src;
+    target = &dst;
+    pool.run(threads, [this](int worker) {
+        runWorker(worker, *source, *target);
+    });
+    dst.setTileSummary(nextFlags);
+
+    stats.tiles = tileRows * tileCols;
+    stats.processed = active;
+    stats.skipped = stats.tiles - active;
+    stats.tasks = (int) tasks.size();
+    stats.threads = threads;
+    stats.steals = 0;
+    double busyMs = 0;
+    bool changed = false;
+    for (int worker = 0; worker < threads; worker++) {
+        stats.steals += workerSteals[worker];
+        busyMs += workerBusyMs[worker];
+        changed = changed || workerChanged[worker];
+    }
+    if (counts) {
+        clearCounts(*counts);
+        for (int worker = 0; worker < threads; worker++) {
+            addCounts(*counts, workerCounts[worker]);
+        }
+    }
+    if (hashDelta) {
+        *hashDelta = 0;
+        for (int worker = 0; worker < threads; worker++) {
+            *hashDelta ^= workerHashes[worker];
+        }
+    }
+    stats.elapsedMs = millisSince(start);
+    stats.idleMs = std::max(0.0, stats.elapsedMs * threads - busyMs);
+    return changed;
+}
+
+TileStats TileScheduler::getStats() const {
+    return stats;
+}
+
+/*
+ * Size the per-tile and per-thread bookkeeping for the given board.
+ */
+void TileScheduler::resize(const CellBoard& src, int maxThreads) {
+    rows = src.numRows();
+    words = src.wordsPerRow();
+    tileRows = src.numTileRows();
+    tileCols = src.numTileCols();
+    taskCols = (tileCols + TASK_TILES - 1) / TASK_TILES;
+    while ((int) deques.size() < maxThreads) {
+        deques.push_back(unique_ptr<WorkStealingDeque>(new WorkStealingDeque()));
+    }
+    workerSteals.resize(maxThreads);
+    workerBusyMs.resize(maxThreads);
+    workerChanged.resize(maxThreads);
+    workerCounts.resize(maxThreads);
+    workerHashes.resize(maxThreads);
+    workerColumns.resize(maxThreads);
+    for (int worker = 0; worker < maxThreads; worker++) {
+        workerColumns[worker].resize(2 * words);
+    }
+}
+
+/*
+ * Record the occupancy flags of every tile in the given tile rows.
+ */
+void TileScheduler::scanTiles(const CellBoard& src, int tileRowStart, int tileRowEnd) {
+    for (int tr = tileRowStart; tr < tileRowEnd; tr++) {
+        unsigned char* flags = &scannedFlags[tr * tileCols];
+        int rowEnd = std::min(rows, (tr + 1) * CellBoard::TILE_ROWS);
+        // walk the rows in memory order, OR-ing each word into its tile's flags
+        for (int r = tr * CellBoard::TILE_ROWS; r < rowEnd; r++) {
+            const uint64_t* high = src.highRow(r);
+            const uint64_t* low = src.lowRow(r);
+            for (int w = 0; w < words; w++) {
+                flags[w] |= (high[w] | low[w]) ? TILE_NON_EMPTY : 0;
+                flags[w] |= high[w] ? TILE_OCCUPIED : 0;
+            }
+        }
+    }
+}
+
+/*
+ * A tile is active if it has any cells, which will age, or if any of its
+ * neighbor tiles (wrapping around the board) has an X or O that could
+ * cause a birth in it.
+ */
+bool TileScheduler::isActive(const vector<unsigned char>& flags, int tileRow, int tileCol) const {
+    if (flags[tileRow * tileCols + tileCol] & TILE_NON_EMPTY) {
+        return true;
+    }
+    for (int dr = -1; dr <= 1; dr++) {
+        int tr = (tileRow + dr + tileRows) % tileRows;
+        for (int dc = -1; dc <= 1; dc++) {
+            int tc = (tileCol + dc + tileCols) % tileCols;
+            if (flags[tr * tileCols + tc] & TILE_OCCUPIED) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+ * An inactive tile stays empty, so its cells in dst just need to be cleared.
+ */
+void TileScheduler::clearTile(CellBoard& dst, int tileRow, int tileCol) const {
+    int rowEnd = std::min(rows, (tileRow + 1) * CellBoard::TILE_ROWS);
+    for (int r = tileRow * CellBoard::TILE_ROWS; r < rowEnd; r++) {
+        dst.highRow(r)[tileCol] = 0;
+        dst.lowRow(r)[tileCol] = 0;
+    }
+}
+
+/*
+ * Advance each run of active tiles in a task with one call to the kernel,
+ * clear the inactive tiles that need it, and record the TileFlags of the
+ * tiles computed, which the kernel collects as it goes.
+ */
+void TileScheduler::runTask(int task, int worker, const CellBoard& src, CellBoard& dst) {
+    int tr = task / taskCols;
+    int firstTile = (task % taskCols) * TASK_TILES;
+    int lastTile = std::min(tileCols, firstTile + TASK_TILES);
+    int rowStart = tr * CellBoard::TILE_ROWS;
+    int rowEnd = std::min(rows, rowStart + CellBoard::TILE_ROWS);
+    uint32_t activeBits = activeMask[task];
+    uint32_t clearBits = clearMask[task];
+
+    int tc = firstTile;
+    while (tc < lastTile) {
+        if (!(activeBits >> (tc - firstTile) & 1)) {
+            if (clearBits >> (tc - firstTile) & 1) {
+                clearTile(dst, tr, tc);
+            }
+            tc++;
+            continue;
+        }
+        int runEnd = tc + 1;
+        while (runEnd < lastTile && (activeBits >> (runEnd - firstTile) & 1)) {
+            runEnd++;
+        }
+        uint64_t* anyHigh = workerColumns[worker].data();
+        uint64_t* anyLow = anyHigh + words;
+        std::fill(anyHigh + tc, anyHigh + runEnd, 0);
+        std::fill(anyLow + tc, anyLow + runEnd, 0);
+        if (advanceRegion(src, dst, rowStart, rowEnd, tc, runEnd, anyHigh, anyLow,
+                          counting ? &workerCounts[worker] : nullptr,
+                          hashing ? &workerHashes[worker] : nullptr)) {
+            workerChanged[worker] = true;
+        }
+        for (int w = tc; w < runEnd; w++) {
+            nextFlags[tr * tileCols + w] = ((anyHigh[w] | anyLow[w]) ? TILE_NON_EMPTY : 0)
+                    | (anyHigh[w] ? TILE_OCCUPIED : 0);
+        }
+        tc = runEnd;
+    }
+}
+
+/*
+ * Body of one thread for one generation: work through its own deque, then
+ * steal from the others until every deque is empty.
+ */
+void TileScheduler::runWorker(int worker, const CellBoard& src, CellBoard& dst) {
+    int task;
+    while (true) {
+        bool found = deques[worker]->pop(task);
+        for (int i = 1; !found && i < threads; i++) {
+            if (deques[(worker + i) % threads]->steal(task)) {
+                found = true;
+                workerSteals[worker]++;
+            }
+        }
+        if (!found) {
+            // no new tasks appear during a generation, so all are taken
+            break;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        runTask(task, worker, src, dst);
+        workerBusyMs[worker] += millisSince(start);
+    }
+}
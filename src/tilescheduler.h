@@ -0,0 +1,121 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares TileScheduler, which advances only the active region
+ * of a board, shared out between threads by work stealing.
+ * See tilescheduler.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _tilescheduler_h
+#define _tilescheduler_h
+
+#include <memory>
+#include <vector>
+#include "cellboard.h"
+#include "lifekernel.h"
+#include "threadpool.h"
+#include "workstealing.h"
+
+/**
+ * Load-balance statistics for one generation of the tile scheduler.
+ */
+struct TileStats {
+    int tiles;          // 64x64 tiles on the board
+    int processed;      // tiles in the active region, run through the kernel
+    int skipped;        // tiles outside the active region
+    int tasks;          // tasks (runs of tiles) handed out to the threads
+    int steals;         // tasks a thread took from another thread's deque
+    int threads;        // threads that took part
+    double idleMs;      // total time threads spent without a task to work on
+    double elapsedMs;   // wall-clock time for the generation
+};
+
+/**
+ * The TileScheduler class tracks the active region of a board as a set of
+ * 64x64 tiles (the tiles of the CellBoard tile summary) and recomputes only
+ * those each generation.
+ *
+ * Under the decay rule every X, O, or C cell changes in every generation
+ * (it ages), and an empty cell changes only if it has 2 or 3 X/O
+ * neighbors.  So the cells that can change in the next generation are
+ * exactly the non-empty cells and the empty cells next to an X or O; a
+ * cell that was born stays active for the three generations it takes to
+ * age from X to -, with no history to keep.  At tile granularity a tile is
+ * active if it is non-empty or one of its eight neighbor tiles (wrapping
+ * around the board) holds an X or O; every other tile is empty now and
+ * stays empty.
+ *
+ * The work is dealt out as tasks of TASK_TILES tiles side by side in one
+ * tile row.  Active tiles next to each other in a task are advanced in one
+ * run, so a busy board costs no more than recomputing it in full.  Tasks
+ * go in row-major runs to one deque per thread; a thread that runs out of
+ * tasks steals from the others, so threads whose part of the board is quiet
+ * help out where it is busy.
+ *
+ * Each generation leaves a tile summary on the board it computes, so when
+ * that board is advanced in turn, inactive tiles are not even read; they
+ * are only written when the destination board still has cells there.
+ */
+class TileScheduler {
+public:
+    /**
+     * Number of tiles side by side that make up one task.
+     */
+    static const int TASK_TILES = 8;
+
+    TileScheduler();
+
+    /**
+     * Computes the generation after src into dst using up to maxThreads
+     * of the threads of pool.
+     * dst must have the same dimensions as src and must not be src.
+     * Returns true if dst differs from src.
+     * If counts is given, it is set to the counts of the generation
+     * computed; skipped tiles are empty and have nothing to count.
+     * If hashDelta is given, it is set to the change of the board's
+     * Zobrist hash; skipped tiles stay empty, so they leave it as it is.
+     */
+    bool advance(ThreadPool& pool, int maxThreads, const CellBoard& src, CellBoard& dst,
+                 RegionCounts* counts = nullptr, std::uint64_t* hashDelta = nullptr);
+
+    /**
+     * Returns the statistics of the most recent call to advance.
+     */
+    TileStats getStats() const;
+
+private:
+    void resize(const CellBoard& src, int maxThreads);
+    void scanTiles(const CellBoard& src, int tileRowStart, int tileRowEnd);
+    bool isActive(const std::vector<unsigned char>& flags, int tileRow, int tileCol) const;
+    void clearTile(CellBoard& dst, int tileRow, int tileCol) const;
+    void runTask(int task, int worker, const CellBoard& src, CellBoard& dst);
+    void runWorker(int worker, const CellBoard& src, CellBoard& dst);
+
+    int rows;
+    int words;
+    int tileRows;
+    int tileCols;
+    int taskCols;
+    int threads;
+    std::vector<unsigned char> scannedFlags;    // TileFlags of src, if it has no summary
+    std::vector<unsigned char> oldDstFlags;     // TileFlags of dst before this generation
+    std::vector<unsigned char> nextFlags;       // TileFlags of dst after this generation
+    std::vector<std::uint32_t> activeMask;     // per task, bit i set if tile i is active
+    std::vector<std::uint32_t> clearMask;     // per task, bit i set if tile i needs clearing
+    std::vector<int> tasks;                     // tasks with any tile to advance or clear
+    std::vector<std::unique_ptr<WorkStealingDeque> > deques;
+    std::vector<int> workerSteals;
+    std::vector<double> workerBusyMs;
+    std::vector<char> workerChanged;
+    std::vector<RegionCounts> workerCounts;     // per thread, if counting
+    std::vector<std::uint64_t> workerHashes;    // per thread, if hashing
+    const CellBoard* source;    // the boards of the generation being computed
+    CellBoard* target;
+    bool counting;
+    bool hashing;
+    std::vector<std::vector<std::uint64_t> > workerColumns;    // scratch for advanceRegion
+    TileStats stats;
+};
+
+#endif // _tilescheduler_h
@@ -0,0 +1,42 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the TripleBuffer class.
+ * See triplebuffer.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "triplebuffer.h"
+
+using namespace std;
+
+TripleBuffer::TripleBuffer() : backIndex(0), frontIndex(1), middle(2) {
+    for (BoardFrame& frame : frames) {
+        frame.generation = 0;
+    }
+}
+
+BoardFrame& TripleBuffer::back() {
+    return frames[backIndex];
+}
+
+void TripleBuffer::publish() {
+    // release makes the frame's contents visible to the consumer that
+    // takes it; acquire makes the consumer's last reads of the frame
+    // handed back happen before the producer overwrites it
+    int old = middle.exchange(backIndex | FRESH, memory_order_acq_rel);
+    backIndex = old & ~FRESH;
+}
+
+bool TripleBuffer::update() {
+    if (!(middle.load(memory_order_relaxed) & FRESH)) {
+        return false;
+    }
+    int old = middle.exchange(frontIndex, memory_order_acq_rel);
+    frontIndex = old & ~FRESH;
+    return true;
+}
+
+const BoardFrame& TripleBuffer::front() const {
+    return frames[frontIndex];
+}
@@ -0,0 +1,77 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares TripleBuffer, which hands boards from the thread that
+ * computes them to the thread that draws them.
+ * See triplebuffer.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _triplebuffer_h
+#define _triplebuffer_h
+
+#include <atomic>
+#include "cellboard.h"
+
+/**
+ * A board and the generation it is at.
+ */
+struct BoardFrame {
+    CellBoard board;
+    long long generation;
+};
+
+/**
+ * A lock-free triple buffer of BoardFrames between one producer thread
+ * and one consumer thread.
+ *
+ * The producer fills the back frame and publishes it; the consumer takes
+ * the most recently published frame as its front frame whenever it is
+ * ready for one.  The third frame sits in between, holding the latest
+ * frame published and not yet taken.  Publishing and taking are a single
+ * atomic exchange each, so neither thread ever waits for the other: a
+ * producer that publishes faster than the consumer takes simply replaces
+ * the frame in between, and the frames it replaces are never drawn.
+ * Each thread owns its frame outright between calls, so the frames need
+ * no locking.
+ */
+class TripleBuffer {
+public:
+    TripleBuffer();
+
+    /**
+     * Returns the frame the producer fills next.  Called by the producer.
+     */
+    BoardFrame& back();
+
+    /**
+     * Makes the back frame the latest one, and gives the producer another
+     * frame to fill.  Called by the producer.
+     */
+    void publish();
+
+    /**
+     * Takes the latest frame as the front frame and returns true if one
+     * was published since the last call, or returns false and keeps the
+     * front frame otherwise.  Called by the consumer.
+     */
+    bool update();
+
+    /**
+     * Returns the frame the consumer took last.  Called by the consumer.
+     */
+    const BoardFrame& front() const;
+
+private:
+    static const int FRESH = 4;     // set in middle when it holds a frame not yet taken
+
+    BoardFrame frames[3];
+    int backIndex;
+    int frontIndex;
+    std::atomic<int> middle;        // index of the frame in between, with FRESH
+
+    TripleBuffer(const TripleBuffer&);              // not copyable
+    TripleBuffer& operator =(const TripleBuffer&);
+};
+
+#endif // _triplebuffer_h
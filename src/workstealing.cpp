@@ -0,0 +1,45 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the WorkStealingDeque class.
+ * See workstealing.h for the declarations of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "workstealing.h"
+
+using namespace std;
+
+WorkStealingDeque::WorkStealingDeque() {
+    // empty
+}
+
+void WorkStealingDeque::clear() {
+    lock_guard<std::mutex> lock(mutex);
+    items.clear();
+}
+
+void WorkStealingDeque::push(int item) {
+    lock_guard<std::mutex> lock(mutex);
+    items.push_back(item);
+}
+
+bool WorkStealingDeque::pop(int& item) {
+    lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) {
+        return false;
+    }
+    item = items.back();
+    items.pop_back();
+    return true;
+}
+
+bool WorkStealingDeque::steal(int& item) {
+    lock_guard<std::mutex> lock(mutex);
+    if (items.empty()) {
+        return false;
+    }
+    item = items.front();
+    items.pop_front();
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares WorkStealingDeque, the per-thread queue of tiles used
+ * by the tile scheduler.
+ * See workstealing.cpp for the implementation of each member.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _workstealing_h
+#define _workstealing_h
+
+#include <deque>
+#include <mutex>
+
+/**
+ * A double-ended queue of work items owned by one thread.
+ * The owner pushes and pops at the back (most recently added, so still
+ * warm in its cache); idle threads steal from the front, which takes the
+ * work farthest from what the owner is doing right now.
+ */
+class WorkStealingDeque {
+public:
+    WorkStealingDeque();
+
+    /**
+     * Removes all items.
+     */
+    void clear();
+
+    /**
+     * Adds an item at the back.  Called by the owner.
+     */
+    void push(int item);
+
+    /**
+     * Removes the item at the back into item and returns true, or returns
+     * false if the deque is empty.  Called by the owner.
+     */
+    bool pop(int& item);
+
+    /**
+     * Removes the item at the front into item and returns true, or returns
+     * false if the deque is empty.  Called by other threads.
+     */
+    bool steal(int& item);
+
+private:
+    std::mutex mutex;
+    std::deque<int> items;
+
+    WorkStealingDeque(const WorkStealingDeque&);              // not copyable
+    WorkStealingDeque& operator =(const WorkStealingDeque&);
+};
+
+#endif // _workstealing_h
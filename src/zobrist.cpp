@@ -0,0 +1,63 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file defines the Zobrist hash of a CellBoard.
+ * See zobrist.h for the documentation of each function.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#include "zobrist.h"
+
+using namespace std;
+
+/*
+ * The finalizer of the SplitMix64 generator: a bijection on 64-bit numbers
+ * whose output bits each depend on every input bit.
+ */
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/*
+ * The key of the word at the given index of the board with the given bit
+ * planes, or 0 if all of its cells are empty.
+ */
+static uint64_t wordKey(uint64_t index, uint64_t high, uint64_t low) {
+    if ((high | low) == 0) {
+        return 0;
+    }
+    return mix(mix(high ^ (index * 0x9e3779b97f4a7c15ULL)) ^ low);
+}
+
+uint64_t zobristHash(const CellBoard& board) {
+    int words = board.wordsPerRow();
+    uint64_t hash = 0;
+    for (int r = 0; r < board.numRows(); r++) {
+        const uint64_t* high = board.highRow(r);
+        const uint64_t* low = board.lowRow(r);
+        uint64_t index = (uint64_t) r * words;
+        for (int w = 0; w < words; w++) {
+            hash ^= wordKey(index + w, high[w], low[w]);
+        }
+    }
+    return hash;
+}
+
+uint64_t zobristRowDelta(uint64_t index,
+                         const uint64_t* oldHigh, const uint64_t* oldLow,
+                         const uint64_t* newHigh, const uint64_t* newLow,
+                         int wordStart, int wordEnd) {
+    uint64_t delta = 0;
+    for (int w = wordStart; w < wordEnd; w++) {
+        if (oldHigh[w] != newHigh[w] || oldLow[w] != newLow[w]) {
+            delta ^= wordKey(index + w, oldHigh[w], oldLow[w])
+                    ^ wordKey(index + w, newHigh[w], newLow[w]);
+        }
+    }
+    return delta;
+}
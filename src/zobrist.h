@@ -0,0 +1,43 @@
+/*
+ * CS 106B/X, Game of Life
+ * This file declares the Zobrist hash of a CellBoard, which lets a run of
+ * generations be checked for repeats without keeping every board.
+ * See zobrist.cpp for the implementation of each function.
+ *
+ * Authors: Bruce Yang and Kevin Li
+ */
+
+#ifndef _zobrist_h
+#define _zobrist_h
+
+#include <cstdint>
+#include "cellboard.h"
+
+/**
+ * Returns the Zobrist hash of a board.
+ *
+ * The hash is the XOR of one pseudo-random 64-bit key for every word of the
+ * board that has a non-empty cell in it, chosen by the word's position and
+ * the contents of both of its bit planes.  The keys are computed with a
+ * mixing function rather than looked up, so there is no table to keep, and
+ * words that are all empty add nothing.  Two boards of the same size with
+ * the same cells always have the same hash; different boards almost never
+ * do, so a matching hash still has to be confirmed by comparing the boards.
+ */
+std::uint64_t zobristHash(const CellBoard& board);
+
+/**
+ * Returns what the words [wordStart, wordEnd) of a row change a board's
+ * hash by when they go from oldHigh/oldLow to newHigh/newLow: the old
+ * keys of the words that differ XORed with their new ones.  XORing the
+ * deltas of every row that changed into the hash of the board before
+ * gives the hash of the board after.  index is the position of the row's
+ * first word in the board, its row times the words per row.
+ * The kernels call this for the rows they change, as they compute them.
+ */
+std::uint64_t zobristRowDelta(std::uint64_t index,
+                              const std::uint64_t* oldHigh, const std::uint64_t* oldLow,
+                              const std::uint64_t* newHigh, const std::uint64_t* newLow,
+                              int wordStart, int wordEnd);
+
+#endif // _zobrist_h